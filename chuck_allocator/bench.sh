@@ -0,0 +1,8 @@
+#!/bin/bash
+
+set -e
+
+g++ -std=c++17 -O2 -I./ bench/bench.cpp -pthread -o chunk_allocator_bench
+g++ -std=c++17 -O2 -I./ bench/compare.cpp -pthread -o allocator_compare
+./chunk_allocator_bench "$@"
+./allocator_compare
@@ -0,0 +1,238 @@
+#include "bench_util.h"
+
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+struct ArenaChunks : task::DefaultChunkPolicy {
+    static const std::size_t chunk_bytes = std::size_t(1) << 30;
+    using backing = task::MmapBacking<true>;
+};
+
+/**
+ * Allocation latency while the number of chunks grows.
+ * Every 60-byte request leaves 40 bytes that never fit the next 60-byte one,
+ * so each of them adds a chunk; every 20-byte request is served from a chunk tail.
+ * With a linear chunk walk ns/op grows with the chunk count, with bins it stays flat.
+ */
+void bench_chunk_growth(std::size_t max_chunks) {
+    task::ChunkAllocator<uint8_t> alloc;
+    std::printf("%-24s %12s %10s\n", "chunk_growth", "chunks", "ns/op");
+    std::size_t chunks = 0;
+    for (std::size_t window = 1000; window <= max_chunks; window *= 10) {
+        std::size_t ops = 0;
+        auto start = Clock::now();
+        while (chunks < window) {
+            alloc.allocate(60);
+            alloc.allocate(20);
+            chunks += 1;
+            ops += 2;
+        }
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        std::printf("%-24s %12zu %10.1f\n", "", chunks, double(ns) / double(ops));
+    }
+}
+
+
+/**
+ * Steady-state churn: vectors grow and die, small blocks are allocated and freed at random.
+ * Returned blocks are reused and empty chunks are freed, so RSS stays flat across rounds.
+ */
+void bench_churn(std::size_t rounds) {
+    task::ChunkAllocator<int, BigChunks> alloc;
+    std::mt19937 rand(42);
+    std::vector<std::pair<int *, std::size_t>> small;
+    std::printf("%-24s %12s %10s %10s\n", "churn", "round", "ns/round", "rss KiB");
+    for (std::size_t round = 1; round <= rounds; ++round) {
+        auto start = Clock::now();
+        {
+            std::vector<int, task::ChunkAllocator<int, BigChunks>> vector(alloc);
+            for (int i = 0; i < 4000; ++i) {
+                vector.push_back(i);
+            }
+        }
+        for (int i = 0; i < 100; ++i) {
+            if (small.size() < 1000 && rand() % 2) {
+                std::size_t n = 1 + rand() % 64;
+                small.emplace_back(alloc.allocate(n), n);
+            } else if (!small.empty()) {
+                std::size_t j = rand() % small.size();
+                alloc.deallocate(small[j].first, small[j].second);
+                small[j] = small.back();
+                small.pop_back();
+            }
+        }
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        if ((round & (round - 1)) == 0) { // report powers of two
+            std::printf("%-24s %12zu %10lld %10ld\n", "", round, static_cast<long long>(ns), current_rss_kib());
+        }
+    }
+    for (auto &block: small) {
+        alloc.deallocate(block.first, block.second);
+    }
+}
+
+
+/**
+ * Throughput of allocate/deallocate pairs when 1..max_threads threads use copies of one allocator.
+ * Each thread keeps a window of live blocks of random sizes and replaces one of them per step.
+ * Policy::pool_shards sets how many locks the refills and flushes of the threads are spread over.
+ */
+template<typename Policy>
+void bench_threads(const char *name, std::size_t max_threads, std::size_t steps) {
+    task::ChunkAllocator<uint8_t, Policy> alloc;
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+        std::vector<std::thread> workers;
+        auto start = Clock::now();
+        for (std::size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([alloc, steps, t]() mutable {
+                std::mt19937 rand(t);
+                const std::size_t window = 64;
+                std::pair<uint8_t *, std::size_t> live[window];
+                for (auto &block: live) {
+                    block.second = 1 + rand() % 256;
+                    block.first = alloc.allocate(block.second);
+                }
+                for (std::size_t step = 0; step < steps; ++step) {
+                    auto &block = live[rand() % window];
+                    alloc.deallocate(block.first, block.second);
+                    block.second = 1 + rand() % 256;
+                    block.first = alloc.allocate(block.second);
+                }
+                for (auto &block: live) {
+                    alloc.deallocate(block.first, block.second);
+                }
+            });
+        }
+        for (auto &worker: workers) {
+            worker.join();
+        }
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        std::printf("%-24s %12zu %10.1f\n", name, threads, 2e3 * double(threads * steps) / double(ns));
+    }
+}
+
+
+/**
+ * One 1 GiB chunk reserved with mmap: the reservation is almost free and only
+ * the carved part of the chunk gets committed and resident.
+ */
+void bench_lazy_commit() {
+    std::printf("%-24s %12s %10s %10s\n", "lazy_commit", "committed", "ns", "rss KiB");
+    auto start = Clock::now();
+    task::ChunkAllocator<uint8_t, ArenaChunks> alloc;
+    alloc.deallocate(alloc.allocate(1), 1); // reserves the chunk
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    std::printf("%-24s %12llu %10lld %10ld\n", "reserve",
+                static_cast<unsigned long long>(alloc.stats().bytes_committed), static_cast<long long>(ns),
+                current_rss_kib());
+    std::vector<uint8_t *> blocks;
+    start = Clock::now();
+    for (int i = 0; i < 16 * 1024; ++i) {
+        blocks.push_back(alloc.allocate(4096));
+        blocks.back()[0] = 1;
+    }
+    ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    std::printf("%-24s %12llu %10lld %10ld\n", "64 MiB carved",
+                static_cast<unsigned long long>(alloc.stats().bytes_committed), static_cast<long long>(ns),
+                current_rss_kib());
+    for (auto block: blocks) {
+        alloc.deallocate(block, 4096);
+    }
+}
+
+
+struct OneShardChunks : SharedChunks {
+    static const std::size_t pool_shards = 1;
+};
+
+struct NumaChunks : BigChunks {
+    static const bool numa_local = true;
+    using backing = task::NumaBacking<>;
+};
+
+/**
+ * Scan bandwidth of worker-local vectors, one worker per CPU. With numa_local every
+ * worker's vector comes from chunks bound to its own node; with one shared pool a
+ * chunk lands wherever it was first touched. On a single-node machine both match.
+ */
+template<typename Policy>
+void bench_local_scan(const char *name, std::size_t ints) {
+    task::ChunkAllocator<long, Policy> alloc;
+    std::size_t workers_count = std::thread::hardware_concurrency();
+    std::vector<std::thread> workers;
+    std::vector<long long> ns(workers_count);
+    for (std::size_t t = 0; t < workers_count; ++t) {
+        workers.emplace_back([alloc, ints, t, &ns]() {
+            std::vector<long, task::ChunkAllocator<long, Policy>> local(alloc);
+            local.reserve(ints);
+            for (std::size_t i = 0; i < ints; ++i) {
+                local.push_back(static_cast<long>(i));
+            }
+            auto start = Clock::now();
+            volatile long sum = 0;
+            for (int pass = 0; pass < 8; ++pass) {
+                long part = 0;
+                for (long x: local) {
+                    part += x;
+                }
+                sum = sum + part;
+            }
+            ns[t] = elapsed_ns(start);
+        });
+    }
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    long long slowest = *std::max_element(ns.begin(), ns.end());
+    double bytes = double(workers_count) * 8 * ints * sizeof(long);
+    std::printf("%-24s %12s %10.2f\n", "", name, bytes / double(slowest));
+}
+
+/**
+ * Request handlers: every request makes thousands of short-lived allocations.
+ * Freeing them one by one is compared with one rollback to a mark taken before
+ * the first request; after warm-up the same chunks serve every request.
+ */
+void bench_requests(std::size_t requests) {
+    const std::size_t per_request = 4096;
+    std::printf("%-24s %12s %10s %10s\n", "requests", "mode", "ns/req", "rss KiB");
+    std::vector<uint8_t *> blocks(per_request);
+    for (int rollback = 0; rollback < 2; ++rollback) {
+        task::ChunkAllocator<uint8_t, BigChunks> alloc;
+        auto start_mark = alloc.mark();
+        auto start = Clock::now();
+        for (std::size_t request = 0; request < requests; ++request) {
+            for (std::size_t i = 0; i < per_request; ++i) {
+                blocks[i] = alloc.allocate(8 + i % 8 * 8);
+                blocks[i][0] = 1;
+            }
+            if (rollback) {
+                alloc.rollback(start_mark);
+            } else {
+                for (std::size_t i = 0; i < per_request; ++i) {
+                    alloc.deallocate(blocks[i], 8 + i % 8 * 8);
+                }
+            }
+        }
+        std::printf("%-24s %12s %10lld %10ld\n", "", rollback ? "rollback" : "deallocate",
+                    elapsed_ns(start) / static_cast<long long>(requests), current_rss_kib());
+    }
+}
+
+int main(int argc, char **argv) {
+    std::size_t max_chunks = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    bench_chunk_growth(max_chunks);
+    bench_churn(1 << 16);
+    bench_lazy_commit();
+    bench_requests(1000);
+    std::printf("%-24s %12s %10s\n", "local_scan", "pool", "GB/s");
+    bench_local_scan<SharedChunks>("shared", 1 << 22);
+    bench_local_scan<NumaChunks>("numa_local", 1 << 22);
+    std::size_t threads = std::max(4u, std::thread::hardware_concurrency());
+    std::printf("%-24s %12s %10s\n", "threads", "threads", "Mops/s");
+    bench_threads<OneShardChunks>("1 shard", threads, 1000000);
+    bench_threads<SharedChunks>("8 shards", threads, 1000000);
+}
@@ -0,0 +1,112 @@
+#ifndef HW_5_ALLOCATOR_BENCH_UTIL_H
+#define HW_5_ALLOCATOR_BENCH_UTIL_H
+
+#include "chunk_allocator.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+using Clock = std::chrono::steady_clock;
+
+struct BigChunks : task::DefaultChunkPolicy {
+    static const std::size_t chunk_bytes = 64 * 1024;
+};
+
+struct SharedChunks : BigChunks {
+    static const bool thread_safe = true;
+};
+
+/// Nanoseconds since start.
+inline long long elapsed_ns(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+/// Resident set size of the process in KiB.
+inline long current_rss_kib() {
+    long pages = 0;
+    long resident = 0;
+    FILE *statm = std::fopen("/proc/self/statm", "r");
+    if (statm == nullptr) {
+        return -1;
+    }
+    if (std::fscanf(statm, "%ld %ld", &pages, &resident) != 2) {
+        resident = -1;
+    }
+    std::fclose(statm);
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+/// Peak resident set size of the process in KiB.
+inline long peak_rss_kib() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * Hardware cache misses of the calling thread and the threads it starts afterwards,
+ * read through perf_event_open. available() is false when the kernel or the
+ * sandbox does not allow it, read() then returns -1.
+ */
+class CacheMissCounter {
+private:
+    int fd = -1;
+
+public:
+    CacheMissCounter() {
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    CacheMissCounter(const CacheMissCounter &) = delete;
+
+    CacheMissCounter &operator=(const CacheMissCounter &) = delete;
+
+    bool available() const {
+        return fd >= 0;
+    }
+
+    void start() {
+        if (available()) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    long long read() {
+        if (!available()) {
+            return -1;
+        }
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        long long misses = 0;
+        if (::read(fd, &misses, sizeof(misses)) != sizeof(misses)) {
+            return -1;
+        }
+        return misses;
+    }
+
+    ~CacheMissCounter() {
+        if (available()) {
+            close(fd);
+        }
+    }
+};
+
+
+#endif //HW_5_ALLOCATOR_BENCH_UTIL_H
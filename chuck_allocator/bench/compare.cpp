@@ -0,0 +1,317 @@
+#include "bench_util.h"
+#include "pool_allocator.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <list>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+
+/// glibc malloc/free behind the allocator interface.
+template<class T>
+struct MallocAllocator {
+    using value_type = T;
+
+    MallocAllocator() = default;
+
+    template<class U>
+    MallocAllocator(const MallocAllocator<U> &) {}
+
+    T *allocate(std::size_t n) {
+        void *p = std::malloc(n * sizeof(T));
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T *>(p);
+    }
+
+    void deallocate(T *p, std::size_t) {
+        std::free(p);
+    }
+};
+
+template<class T, class U>
+bool operator==(const MallocAllocator<T> &, const MallocAllocator<U> &) {
+    return true;
+}
+
+template<class T, class U>
+bool operator!=(const MallocAllocator<T> &, const MallocAllocator<U> &) {
+    return false;
+}
+
+
+/**
+ * Monotonic arena: one lazily committed reservation, allocation is an atomic bump
+ * and deallocation does nothing. The lower bound for allocation cost and the upper
+ * bound for footprint.
+ */
+class BumpArena {
+private:
+    static const std::size_t capacity = std::size_t(16) << 30;
+
+    uint8_t *base;
+    std::atomic<std::size_t> top{0};
+
+public:
+    BumpArena() {
+        void *p = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        base = static_cast<uint8_t *>(p);
+    }
+
+    BumpArena(const BumpArena &) = delete;
+
+    BumpArena &operator=(const BumpArena &) = delete;
+
+    void *allocate(std::size_t bytes, std::size_t align) {
+        std::size_t offset = top.load(std::memory_order_relaxed);
+        std::size_t start;
+        do {
+            start = (offset + align - 1) & ~(align - 1);
+            if (start + bytes > capacity) {
+                throw std::bad_alloc();
+            }
+        } while (!top.compare_exchange_weak(offset, start + bytes, std::memory_order_relaxed));
+        return base + start;
+    }
+
+    ~BumpArena() {
+        munmap(base, capacity);
+    }
+};
+
+template<class T>
+struct BumpAllocator {
+    using value_type = T;
+
+    std::shared_ptr<BumpArena> arena;
+
+    BumpAllocator() : arena(std::make_shared<BumpArena>()) {}
+
+    template<class U>
+    BumpAllocator(const BumpAllocator<U> &other) : arena(other.arena) {}
+
+    T *allocate(std::size_t n) {
+        return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *, std::size_t) {}
+};
+
+template<class T, class U>
+bool operator==(const BumpAllocator<T> &lhs, const BumpAllocator<U> &rhs) {
+    return lhs.arena == rhs.arena;
+}
+
+template<class T, class U>
+bool operator!=(const BumpAllocator<T> &lhs, const BumpAllocator<U> &rhs) {
+    return !(lhs == rhs);
+}
+
+
+/// What one run of a pattern reports back to the parent.
+struct Result {
+    long long ns = 0;
+    long long ops = 0;
+    long long cache_misses = -1;
+    long peak_rss_kib = 0;
+};
+
+
+/// Appends n ints to a fresh vector, 16 rounds.
+template<class Alloc>
+long long vector_growth(std::size_t n) {
+    volatile int last = 0;
+    for (int round = 0; round < 16; ++round) {
+        std::vector<int, typename std::allocator_traits<Alloc>::template rebind_alloc<int>> v;
+        for (std::size_t i = 0; i < n; ++i) {
+            v.push_back(static_cast<int>(i));
+        }
+        last = v.back();
+    }
+    (void) last;
+    return 16 * static_cast<long long>(n);
+}
+
+/// Builds a list of n small nodes, walks it and tears it down.
+template<class Alloc>
+long long small_nodes(std::size_t n) {
+    std::list<int, typename std::allocator_traits<Alloc>::template rebind_alloc<int>> l;
+    for (std::size_t i = 0; i < n; ++i) {
+        l.push_back(static_cast<int>(i));
+    }
+    volatile long long sum = 0;
+    for (int x: l) {
+        sum = sum + x;
+    }
+    return 2 * static_cast<long long>(n);
+}
+
+/// Batches of 64 blocks freed in reverse order, stack discipline.
+template<class Alloc>
+long long lifo_churn(std::size_t n) {
+    typename std::allocator_traits<Alloc>::template rebind_alloc<uint8_t> alloc;
+    const std::size_t batch = 64;
+    uint8_t *live[batch];
+    for (std::size_t step = 0; step < n; step += batch) {
+        for (std::size_t i = 0; i < batch; ++i) {
+            live[i] = alloc.allocate(16 + i % 4 * 16);
+            live[i][0] = 1;
+        }
+        for (std::size_t i = batch; i-- > 0;) {
+            alloc.deallocate(live[i], 16 + i % 4 * 16);
+        }
+    }
+    return 2 * static_cast<long long>(n);
+}
+
+/// A ring of 4096 live blocks; every step frees the oldest one and allocates a new one.
+template<class Alloc>
+long long fifo_churn(std::size_t n) {
+    typename std::allocator_traits<Alloc>::template rebind_alloc<uint8_t> alloc;
+    const std::size_t window = 4096;
+    std::vector<uint8_t *> live(window);
+    for (std::size_t i = 0; i < window; ++i) {
+        live[i] = alloc.allocate(16 + i % 4 * 16);
+    }
+    for (std::size_t step = 0; step < n; ++step) {
+        std::size_t i = step % window;
+        alloc.deallocate(live[i], 16 + i % 4 * 16);
+        live[i] = alloc.allocate(16 + i % 4 * 16);
+        live[i][0] = 1;
+    }
+    for (std::size_t i = 0; i < window; ++i) {
+        alloc.deallocate(live[i], 16 + i % 4 * 16);
+    }
+    return 2 * static_cast<long long>(n + window);
+}
+
+/**
+ * A producer allocates messages and hands them to a consumer through a
+ * single-producer single-consumer ring; the consumer frees them, so every
+ * block is released by a thread other than the one that allocated it.
+ */
+template<class Alloc>
+long long producer_consumer(std::size_t n) {
+    using ByteAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<uint8_t>;
+    const std::size_t slots = 1024;
+    const std::size_t bytes = 48;
+    std::vector<std::atomic<uint8_t *>> ring(slots);
+    for (auto &slot: ring) {
+        slot.store(nullptr, std::memory_order_relaxed);
+    }
+    ByteAlloc alloc;
+    std::thread consumer([&ring, alloc, n]() mutable {
+        for (std::size_t i = 0; i < n; ++i) {
+            auto &slot = ring[i % slots];
+            uint8_t *msg;
+            while ((msg = slot.load(std::memory_order_acquire)) == nullptr) {
+                std::this_thread::yield();
+            }
+            slot.store(nullptr, std::memory_order_relaxed);
+            alloc.deallocate(msg, bytes);
+        }
+    });
+    for (std::size_t i = 0; i < n; ++i) {
+        uint8_t *msg = alloc.allocate(bytes);
+        msg[0] = static_cast<uint8_t>(i);
+        auto &slot = ring[i % slots];
+        while (slot.load(std::memory_order_acquire) != nullptr) {
+            std::this_thread::yield();
+        }
+        slot.store(msg, std::memory_order_release);
+    }
+    consumer.join();
+    return 2 * static_cast<long long>(n);
+}
+
+
+/**
+ * Runs one pattern in a forked child so that peak RSS belongs to that run
+ * alone, and reads its Result back through a pipe.
+ */
+template<class Pattern>
+Result measure(Pattern pattern) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return Result{};
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        CacheMissCounter misses;
+        Result result;
+        misses.start();
+        auto start = Clock::now();
+        result.ops = pattern();
+        result.ns = elapsed_ns(start);
+        result.cache_misses = misses.read();
+        result.peak_rss_kib = peak_rss_kib();
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == sizeof(result) ? 0 : 1);
+    }
+    close(fds[1]);
+    Result result;
+    if (pid < 0 || read(fds[0], &result, sizeof(result)) != sizeof(result)) {
+        result = Result{};
+    }
+    close(fds[0]);
+    if (pid > 0) {
+        waitpid(pid, nullptr, 0);
+    }
+    return result;
+}
+
+void report(const char *pattern, const char *allocator, const Result &result) {
+    std::string misses = result.cache_misses < 0 ? "n/a" : std::to_string(result.cache_misses);
+    double ns_per_op = result.ops > 0 ? double(result.ns) / double(result.ops) : 0;
+    std::printf("%-18s %-8s %10.1f %12ld %14s\n", pattern, allocator, ns_per_op, result.peak_rss_kib,
+                misses.c_str());
+}
+
+/// Runs pattern Bench with every allocator; Chunk is the ChunkAllocator flavour to use.
+template<template<class> class Bench, class Chunk>
+void compare(const char *pattern, std::size_t n) {
+    report(pattern, "std", measure([n] { return Bench<std::allocator<uint8_t>>::run(n); }));
+    report(pattern, "malloc", measure([n] { return Bench<MallocAllocator<uint8_t>>::run(n); }));
+    report(pattern, "bump", measure([n] { return Bench<BumpAllocator<uint8_t>>::run(n); }));
+    report(pattern, "chunk", measure([n] { return Bench<Chunk>::run(n); }));
+}
+
+#define BENCH_PATTERN(name) \
+    template<class Alloc> \
+    struct name##_bench { \
+        static long long run(std::size_t n) { return name<Alloc>(n); } \
+    }
+
+BENCH_PATTERN(vector_growth);
+BENCH_PATTERN(small_nodes);
+BENCH_PATTERN(lifo_churn);
+BENCH_PATTERN(fifo_churn);
+BENCH_PATTERN(producer_consumer);
+
+
+int main(int argc, char **argv) {
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    using Chunk = task::ChunkAllocator<uint8_t, BigChunks>;
+    using SharedChunk = task::ChunkAllocator<uint8_t, SharedChunks>;
+
+    std::printf("%-18s %-8s %10s %12s %14s\n", "pattern", "alloc", "ns/op", "peak KiB", "cache misses");
+    compare<vector_growth_bench, Chunk>("vector_growth", n);
+    compare<small_nodes_bench, Chunk>("small_nodes", n);
+    report("small_nodes", "pool", measure([n] { return small_nodes<task::PoolAllocator<uint8_t, BigChunks>>(n); }));
+    compare<lifo_churn_bench, Chunk>("lifo_churn", n);
+    compare<fifo_churn_bench, Chunk>("fifo_churn", n);
+    compare<producer_consumer_bench, SharedChunk>("producer_consumer", n);
+    return 0;
+}
@@ -1,11 +1,30 @@
 #include "chunk_allocator.h"
+#include "pool_allocator.h"
 
 #include <iostream>
+#include <list>
+#include <map>
+#include <thread>
 #include <vector>
 
 
 using namespace std;
 
+struct TracedChunks : task::DefaultChunkPolicy {
+    using tracer = task::RingTrace<64>;
+};
+
+struct NumaChunks : task::DefaultChunkPolicy {
+    static const std::size_t chunk_bytes = 64 * 1024;
+    static const bool numa_local = true;
+    using backing = task::NumaBacking<>;
+};
+
+struct CacheLineChunks : task::DefaultChunkPolicy {
+    static const std::size_t chunk_bytes = 64 * 1024;
+    static const std::size_t alignment = 64;
+};
+
 // Tests
 class A {
     int x;
@@ -115,6 +134,128 @@ int main() {
         cout << "\ndestructors" << endl;
     }
 
+    cout << "\n" << endl;
+    {
+        cout << "vector bigger than a chunk" << endl;
+        task::ChunkAllocator<int> allocator;
+        std::vector<int, decltype(allocator)> vector1(allocator);
+        for (int i = 0; i < 1000000; ++i) {
+            vector1.push_back(i);
+        }
+        long long sum = 0;
+        for (auto el: vector1) {
+            sum += el;
+        }
+        cout << "sum " << sum << endl;
+        cout << allocator.stats().to_json() << endl;
+    }
+
+    cout << "\n" << endl;
+    {
+        cout << "node containers share the pool with rebound allocators" << endl;
+        task::ChunkAllocator<int> allocator;
+        std::list<int, decltype(allocator)> list1(allocator);
+        std::map<int, int, std::less<int>, task::ChunkAllocator<std::pair<const int, int>>> map1(allocator);
+        for (int i = 0; i < 10; ++i) {
+            list1.push_back(i);
+            map1[i] = i;
+        }
+        cout << "equal: " << (list1.get_allocator() == allocator and map1.get_allocator() == allocator) << endl;
+        cout << "allocations in the shared pool: " << allocator.stats().bytes_in_use << " bytes" << endl;
+
+        std::vector<int, decltype(allocator)> vector1(5, 1, allocator);
+        std::vector<int, decltype(allocator)> vector2;
+        const int *data = vector1.data();
+        vector2 = std::move(vector1);
+        cout << "move-assignment steals the buffer: " << (vector2.data() == data) << endl;
+    }
+
+    cout << "\n" << endl;
+    {
+        cout << "64 KiB chunks aligned to cache lines" << endl;
+        task::ChunkAllocator<double, CacheLineChunks> allocator;
+        std::vector<double, decltype(allocator)> vector1(allocator);
+        for (int i = 0; i < 1000; ++i) {
+            vector1.push_back(i);
+        }
+        char *p1 = reinterpret_cast<char *>(allocator.allocate(1));
+        char *p2 = reinterpret_cast<char *>(allocator.allocate(3));
+        cout << "aligned: " << (reinterpret_cast<uintptr_t>(vector1.data()) % 64 == 0 and
+                                reinterpret_cast<uintptr_t>(p1) % 64 == 0 and
+                                reinterpret_cast<uintptr_t>(p2) % 64 == 0) << endl;
+        cout << allocator.stats().to_json() << endl;
+    }
+
+    cout << "\n" << endl;
+    {
+        cout << "traced allocator" << endl;
+        {
+            task::ChunkAllocator<A, TracedChunks> allocator;
+            std::vector<A, decltype(allocator)> vector1(allocator);
+            vector1.emplace_back(1, 2);
+            vector1.emplace_back(3, 4);
+        }
+        TracedChunks::tracer::dump(cout);
+    }
+
+    cout << "\n" << endl;
+    {
+        cout << "requests rolled back to a mark" << endl;
+        task::ChunkAllocator<int> allocator;
+        auto start = allocator.mark();
+        for (int request = 0; request < 3; ++request) {
+            int *first = allocator.allocate(1);
+            for (int i = 0; i < 10; ++i) {
+                allocator.allocate(1 + i % 3)[0] = request * i; // never deallocated one by one
+            }
+            cout << "request " << request << ": " << allocator.stats().bytes_in_use << " bytes in "
+                 << allocator.stats().chunks << " chunks from " << first << endl;
+            allocator.rollback(start);
+        }
+        allocator.reset();
+        cout << "after reset: " << allocator.stats().bytes_in_use << " bytes" << endl;
+    }
+
+    cout << "\n" << endl;
+    {
+        cout << "fixed-size nodes from slot pools" << endl;
+        task::PoolAllocator<int, CacheLineChunks> allocator;
+        std::list<int, decltype(allocator)> list1(allocator);
+        for (int i = 0; i < 10000; ++i) {
+            list1.push_back(i);
+        }
+        for (int i = 0; i < 5000; ++i) {
+            list1.pop_front();
+            list1.push_back(i);
+        }
+        // with 64-byte alignment ints and list nodes share one pool of cache-line slots
+        cout << "slot " << decltype(allocator)::SLOT << " bytes, chunks " << allocator.chunks() << endl;
+    }
+
+    cout << "\n" << endl;
+    {
+        cout << "chunks on the NUMA node of the calling thread" << endl;
+        task::ChunkAllocator<int, NumaChunks> allocator;
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 2; ++t) {
+            workers.emplace_back([allocator]() {
+                std::vector<int, decltype(allocator)> local(allocator);
+                for (int i = 0; i < 100000; ++i) {
+                    local.push_back(i);
+                }
+            });
+        }
+        for (auto &worker: workers) {
+            worker.join();
+        }
+        std::list<int, decltype(allocator)> list1(allocator);
+        for (int i = 0; i < 1000; ++i) {
+            list1.push_back(i);
+        }
+        cout << "nodes " << task::numa_nodes() << ", this thread on node " << task::current_numa_node()
+             << ", chunks " << allocator.stats().chunks << ", in use " << allocator.stats().bytes_in_use << endl;
+    }
+
 
 }
 
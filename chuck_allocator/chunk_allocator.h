@@ -1,170 +1,1225 @@
 #ifndef HW_5_ALLOCATOR_CHUNK_ALLOCATOR_H
 #define HW_5_ALLOCATOR_CHUNK_ALLOCATOR_H
 
-#define DEBUG  true
-
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <limits>
 #include <memory>
-#include <iostream>
+#include <mutex>
+#include <new>
 #include <list>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "chunk_backing.h"
+#include "chunk_stats.h"
+#include "chunk_trace.h"
 
 
 namespace task {
 
+    /// Index of the highest set bit, i.e. floor(log2(x)) for x > 0.
+    constexpr std::size_t log2_floor(std::size_t x) {
+        std::size_t res = 0;
+        while (x >>= 1u) {
+            res += 1;
+        }
+        return res;
+    }
+
+    /// Smallest k with 2^k >= x.
+    constexpr std::size_t log2_ceil(std::size_t x) {
+        return (x <= 1) ? 0 : log2_floor(x - 1) + 1;
+    }
+
     /**
      * Responsible for allocating and manage memory.
+     * N is the size of the block in bytes, A is the alignment of its start.
+     * The chunk lives in a header at the start of its own memory, the block follows it,
+     * so a chunk is one reservation from Backing and its bookkeeping is one hop away.
+     * The reservation is aligned to span(), the power of two that covers it, so the header
+     * of a block is found by masking the block address, see of().
+     * With a lazy backing the memory is committed in Backing::commit_step pieces
+     * as index moves forward.
      */
-    template<size_t N>
+    template<size_t N, size_t A = alignof(std::max_align_t), typename Backing = HeapBacking>
     class Chunk {
+        static_assert((A & (A - 1)) == 0, "Chunk: alignment must be a power of two");
+    public:
+        static const std::size_t CAPACITY = N;
+        static const std::size_t ALIGNMENT = A;
+        static const std::size_t CLASSES = log2_ceil(N) + 1; // a block of class k has min(2^k, N) bytes
+
+        // Hot fields first, walking chunks reads only the first cache line.
+        Chunk *next = nullptr; // neighbours inside ChunkList
+        Chunk *prev = nullptr;
+
     private:
-        uint8_t *p; // pointer to block with CHUNK_SIZE bytes
-        size_t index;// size of block part of spent memory
+        size_t index; // size of block part of spent memory
+        size_t committed; // bytes from the start of the header that are backed by memory
+
     public:
+        std::size_t live = 0; // blocks handed out and not returned yet
+        Chunk *bin_prev = nullptr; // neighbours inside FreeBins
+        Chunk *bin_next = nullptr;
+        uint64_t saved_epoch = 0; // mark epoch in which the pool last journaled index and live
+        const void *owner = nullptr; // pool that made the chunk
+
+        void *free_heads[CLASSES] = {}; // intrusive lists of returned blocks by size class
+        Chunk *class_prev[CLASSES] = {}; // neighbours inside FreeBlocks
+        Chunk *class_next[CLASSES] = {};
+
+    private:
+        explicit Chunk(std::size_t committed) : index(0), committed(committed) {}
 
-        explicit Chunk() : index(0) {
-            p = new uint8_t[N];
-#ifdef DEBUG
-            std::cout << "Chunk CONSTRUCTED at " << this << " points to " << std::hex << std::showbase
-                      << reinterpret_cast<void *>(p) << std::dec << std::endl;
-#endif
+        /// Bytes from the start of the header to the block, the block stays aligned to A.
+        static std::size_t header_bytes() {
+            return (sizeof(Chunk) + A - 1) / A * A;
         }
 
-        Chunk(const Chunk &other) {
-#ifdef DEBUG
-            std::cout << "Chunk : copy-constructed at " << this << std::endl;
-#endif
-            if (this != &other) {
+        /// Part of the memory that stays committed while the chunk exists: the header and what shares its pages.
+        static std::size_t pinned_bytes() {
+            if (!Backing::lazy_commit) {
+                return header_bytes() + N;
             }
-        };
+            std::size_t pinned = (header_bytes() + Backing::commit_step - 1) / Backing::commit_step * Backing::commit_step;
+            return (pinned < header_bytes() + N) ? pinned : header_bytes() + N;
+        }
+
+        uint8_t *base() {
+            return reinterpret_cast<uint8_t *>(this);
+        }
+
+        uint8_t *p() {
+            return base() + header_bytes();
+        }
+
+        const uint8_t *p() const {
+            return reinterpret_cast<const uint8_t *>(this) + header_bytes();
+        }
+
+        /// Makes the block usable up to end.
+        void commit(std::size_t end) {
+            end += header_bytes();
+            if (!Backing::lazy_commit || end <= this->committed) {
+                return;
+            }
+            std::size_t upto = (end + Backing::commit_step - 1) / Backing::commit_step * Backing::commit_step;
+            upto = (upto < header_bytes() + N) ? upto : header_bytes() + N;
+            Backing::commit(base() + this->committed, upto - this->committed);
+            this->committed = upto;
+        }
+
+    public:
+        Chunk(const Chunk &) = delete;
+
+        Chunk &operator=(const Chunk &) = delete;
+
+        /// Alignment of the reservation: the smallest power of two not below the header and the block.
+        static std::size_t span() {
+            return std::size_t(1) << log2_ceil(header_bytes() + N);
+        }
+
+        /// Chunk holding the byte at ptr, which must lie in the block of some chunk.
+        static Chunk *of(const void *ptr) {
+            return reinterpret_cast<Chunk *>(reinterpret_cast<uintptr_t>(ptr) & ~(span() - 1));
+        }
+
+        /// Reserves memory for the header and the block and builds the chunk in it.
+        static Chunk *create() {
+            void *memory = Backing::reserve(header_bytes() + N, span());
+            if (Backing::lazy_commit) {
+                try {
+                    Backing::commit(memory, pinned_bytes());
+                } catch (...) {
+                    Backing::release(memory, header_bytes() + N, span());
+                    throw;
+                }
+            }
+            return new(memory) Chunk(pinned_bytes());
+        }
+
+        /// Gives the memory of chunk back to Backing.
+        static void destroy(Chunk *chunk) noexcept {
+            chunk->~Chunk();
+            Backing::release(chunk, header_bytes() + N, span());
+        }
+
+        /// Returns number of bytes carved from the block so far.
+        std::size_t get_size_of_used_memory() const {
+            return this->index;
+        }
 
         /// Returns number of bytes that can be used for data.
         std::size_t get_size_of_free_memory() const {
             return N - this->index;
         }
 
+        /// Number of bytes to skip so that the next block starts at align (a power of two).
+        std::size_t padding(std::size_t align) const {
+            auto address = reinterpret_cast<uintptr_t>(p() + this->index);
+            return (align - address % align) % align;
+        }
+
         /// Is allocatable.
-        bool can_allocate(size_t bytes) const {
-            return (get_size_of_free_memory() >= bytes);
+        bool can_allocate(size_t bytes, size_t align = 1) const {
+            return (get_size_of_free_memory() >= bytes + padding(align));
         }
 
-        /// Returns pointer to allocated place.
-        uint8_t *allocate(std::size_t n) {
+        /// Returns pointer to allocated place aligned to align.
+        uint8_t *allocate(std::size_t n, std::size_t align = 1) {
 
-            if (!can_allocate(n)) {
-#ifdef DEBUG
-                std::cout << "Chunk: requested more bytes than defined in constructor " << N << " while your n is ("
-                          << n << ")" << std::endl;
-#endif
+            if (!can_allocate(n, align)) {
                 throw std::bad_alloc();
             }
-            auto res = p + this->index;
-            this->index += n;
-#ifdef DEBUG
-            std::cout << "Chunk at " << this << " allocate" << " : " << std::hex << std::showbase
-                      << reinterpret_cast<void *>(res) << std::dec << std::endl;
-#endif
+            auto res = p() + this->index + padding(align);
+            commit((res - p()) + n);
+            this->index = (res - p()) + n;
             return res;
         }
 
 
-        /// Checks the chunk is allocated.
-        bool is_empty() const {
-#ifdef DEBUG
-            if (p == nullptr) {
-                std::cout << "Chunk is empty." << std::endl;
+        /// Start of the memory block.
+        const uint8_t *data() const {
+            return p();
+        }
+
+        /// Checks that block of bytes at ptr is the last one carved from the chunk.
+        bool is_last(const uint8_t *ptr, std::size_t bytes) const {
+            return ptr + bytes == p() + this->index;
+        }
+
+        /// Returns the last carved block starting at ptr to the free tail.
+        void give_back(const uint8_t *ptr) {
+            this->index = ptr - p();
+        }
+
+        /// Moves the free tail back to start at used, committed memory stays committed.
+        void rewind(std::size_t used) {
+            this->index = used;
+        }
+
+        /// Forgets all blocks, the chunk must have no live ones. Committed memory past the header is given back.
+        void reset() {
+            this->index = 0;
+            std::fill(free_heads, free_heads + CLASSES, nullptr);
+            if (Backing::lazy_commit && this->committed > pinned_bytes()) {
+                Backing::decommit(base() + pinned_bytes(), this->committed - pinned_bytes());
+                this->committed = pinned_bytes();
             }
-#endif
-            return (p == nullptr);
+        }
+
+        /// Number of bytes of the header and the block that are backed by memory.
+        std::size_t committed_bytes() const {
+            return this->committed;
         }
 
 
         std::size_t max_size() const {
             return N;
         }
+    };
 
-        ~Chunk() {
-#ifdef DEBUG
-            std::cout << "~Chunk() at" << this << std::endl;
-#endif
-            if (p != nullptr) {
-#ifdef DEBUG
-                std::cout << "~Chunk pointer to " << std::hex << std::showbase << reinterpret_cast<void *>(p)
-                          << std::dec << std::endl;
-#endif
-                delete[] static_cast<uint8_t *>(p);
+
+    /**
+     * Intrusive list of chunks, linked through their headers. It owns the chunks.
+     */
+    template<typename C>
+    class ChunkList {
+    public:
+        C *begin; // start chunk of list
+        C *last; // tail chunk of list
+        std::size_t size;
+
+
+        ChunkList() : begin(nullptr), last(nullptr), size(0) {
+        }
+
+        ChunkList(const ChunkList &) = delete;
+
+        ChunkList &operator=(const ChunkList &) = delete;
+
+
+        /**
+         * Creates another chunk at the tail
+         */
+        C *add() {
+            auto chunk = C::create();
+            if (!begin) {
+                begin = chunk;
+            } else {
+                last->next = chunk;
+                chunk->prev = last;
+            }
+            last = chunk;
+            size += 1;
+            return chunk;
+        }
+
+        /**
+         * Unlinks chunk and destroys it.
+         */
+        void remove(C *chunk) {
+            if (chunk->prev != nullptr) {
+                chunk->prev->next = chunk->next;
+            } else {
+                begin = chunk->next;
+            }
+            if (chunk->next != nullptr) {
+                chunk->next->prev = chunk->prev;
+            } else {
+                last = chunk->prev;
+            }
+            size -= 1;
+            C::destroy(chunk);
+        }
+
+        bool is_empty() {
+            return (size == 0);
+        }
+
+
+        ~ChunkList() {
+            while (begin != nullptr) {
+                auto chunk = begin;
+                begin = begin->next;
+                C::destroy(chunk);
             }
         }
     };
 
+
     /**
-     * Node in a List.
+     * Size-class bins of chunks with free space.
+     * A chunk with f free bytes lives in bin floor(log2(f)), so every chunk of bin k
+     * can serve any request of at most 2^k bytes. Lookup takes the first non-empty
+     * bin k >= ceil(log2(bytes)) from a bit mask, insert and remove are O(1).
+     * Full chunks are not kept in any bin.
      */
-    template<typename T>
-    class Node {
+    template<typename C>
+    class FreeBins {
+    private:
+        static const std::size_t BINS = log2_floor(C::CAPACITY) + 1;
+        static_assert(BINS <= 64, "FreeBins: chunk size is too big for the bin mask");
+
+        C *heads[BINS] = {}; // bin k holds chunks with free space in [2^k, 2^(k+1))
+        uint64_t mask = 0; // bit k is set when bin k is not empty
+
+        static std::size_t bin_of(std::size_t free_bytes) {
+            return log2_floor(free_bytes);
+        }
+
     public:
-        T *data; //pointer to data.
-        Node *next; // pointer to next Node
+        /// Puts chunk into the bin matching its free space. Full chunks are skipped.
+        void insert(C *chunk) {
+            std::size_t free_bytes = chunk->get_size_of_free_memory();
+            if (free_bytes == 0) {
+                return;
+            }
+            std::size_t k = bin_of(free_bytes);
+            chunk->bin_prev = nullptr;
+            chunk->bin_next = heads[k];
+            if (heads[k] != nullptr) {
+                heads[k]->bin_prev = chunk;
+            }
+            heads[k] = chunk;
+            mask |= (uint64_t(1) << k);
+        }
 
-        Node() : data(new T()), next(nullptr) {}
+        /// Takes chunk out of its bin. Must be called before chunk's free space changes.
+        void remove(C *chunk) {
+            std::size_t free_bytes = chunk->get_size_of_free_memory();
+            if (free_bytes == 0) {
+                return;
+            }
+            std::size_t k = bin_of(free_bytes);
+            if (chunk->bin_prev != nullptr) {
+                chunk->bin_prev->bin_next = chunk->bin_next;
+            } else {
+                heads[k] = chunk->bin_next;
+            }
+            if (chunk->bin_next != nullptr) {
+                chunk->bin_next->bin_prev = chunk->bin_prev;
+            }
+            chunk->bin_prev = chunk->bin_next = nullptr;
+            if (heads[k] == nullptr) {
+                mask &= ~(uint64_t(1) << k);
+            }
+        }
 
+        /**
+         * Returns a chunk that fits bytes aligned to align or nullptr.
+         * Only heads of the bins are checked, so at most BINS chunks are touched.
+         * Checked chunks that could not fit the block are added to failed_probes.
+         */
+        C *find(std::size_t bytes, std::size_t align, std::size_t &failed_probes) const {
+            std::size_t exact = log2_floor(bytes);
+            if (exact < BINS && heads[exact] != nullptr) {
+                if (heads[exact]->can_allocate(bytes, align)) {
+                    return heads[exact]; // bin of the request itself may hold a fitting chunk at its head
+                }
+                failed_probes += 1;
+            }
+            std::size_t k = log2_ceil(bytes);
+            if (k >= BINS) {
+                return nullptr;
+            }
+            uint64_t candidates = mask & (~uint64_t(0) << k);
+            while (candidates != 0) {
+                auto chunk = heads[__builtin_ctzll(candidates)];
+                if (chunk->can_allocate(bytes, align)) { // fails only because of alignment padding
+                    return chunk;
+                }
+                failed_probes += 1;
+                candidates &= candidates - 1;
+            }
+            return nullptr;
+        }
     };
 
 
     /**
-     * Simple list.
+     * Returned blocks of all chunks.
+     * Every chunk threads its returned blocks of class k through free_heads[k],
+     * the next pointer is stored inside the block itself. Chunks that have blocks
+     * of class k are linked into list k, so a block is found in O(1).
      */
-    template<typename T>
-    class SimpleList {
+    template<typename C>
+    class FreeBlocks {
+    private:
+        C *heads[C::CLASSES] = {}; // list k holds chunks with returned blocks of class k
+
+        void link(C *chunk, std::size_t k) {
+            chunk->class_prev[k] = nullptr;
+            chunk->class_next[k] = heads[k];
+            if (heads[k] != nullptr) {
+                heads[k]->class_prev[k] = chunk;
+            }
+            heads[k] = chunk;
+        }
+
+        void unlink(C *chunk, std::size_t k) {
+            if (chunk->class_prev[k] != nullptr) {
+                chunk->class_prev[k]->class_next[k] = chunk->class_next[k];
+            } else {
+                heads[k] = chunk->class_next[k];
+            }
+            if (chunk->class_next[k] != nullptr) {
+                chunk->class_next[k]->class_prev[k] = chunk->class_prev[k];
+            }
+            chunk->class_prev[k] = chunk->class_next[k] = nullptr;
+        }
+
     public:
-        Node<T> *begin; // start node of list
-        std::size_t size;
+        /// Threads block of class k onto the free list of its chunk.
+        void push(C *chunk, std::size_t k, uint8_t *block) {
+            std::memcpy(block, &chunk->free_heads[k], sizeof(void *));
+            if (chunk->free_heads[k] == nullptr) {
+                link(chunk, k);
+            }
+            chunk->free_heads[k] = block;
+        }
 
+        /**
+         * Takes a returned block of class k aligned to align.
+         * @return the block and its chunk in chunk, or nullptr if there is no such block at hand.
+         */
+        uint8_t *pop(std::size_t k, std::size_t align, C *&chunk) {
+            chunk = heads[k];
+            if (chunk == nullptr) {
+                return nullptr;
+            }
+            auto block = static_cast<uint8_t *>(chunk->free_heads[k]);
+            if (reinterpret_cast<uintptr_t>(block) % align != 0) {
+                return nullptr;
+            }
+            std::memcpy(&chunk->free_heads[k], block, sizeof(void *));
+            if (chunk->free_heads[k] == nullptr) {
+                unlink(chunk, k);
+            }
+            return block;
+        }
 
-        SimpleList() : begin(nullptr), size(0) {
-#ifdef DEBUG
-            std::cout << "SimpleList() at" << this << std::endl;
-#endif
+        /// Drops all returned blocks of chunk.
+        void forget(C *chunk) {
+            for (std::size_t k = 0; k < C::CLASSES; ++k) {
+                if (chunk->free_heads[k] != nullptr) {
+                    unlink(chunk, k);
+                    chunk->free_heads[k] = nullptr;
+                }
+            }
         }
+    };
 
 
+    /**
+     * Compile-time settings of ChunkAllocator.
+     * To change them derive from DefaultChunkPolicy and hide the members, e.g.
+     *     struct BigChunks : task::DefaultChunkPolicy {
+     *         static const std::size_t chunk_bytes = 64 * 1024;
+     *         static const std::size_t alignment = 64;
+     *     };
+     */
+    struct DefaultChunkPolicy {
+        static const std::size_t chunk_bytes = 100; // size of every chunk
+        static const std::size_t alignment = 0; // minimal alignment of every block, alignof(T) is used when bigger
+        static const std::size_t empty_chunk_cache = 1; // empty chunks kept for reuse, the rest are freed
+        static const bool thread_safe = false; // copies of the allocator may be used from different threads
+        static const std::size_t pool_shards = 8; // locked ChunkPool-s behind the thread caches of a thread_safe pool
+        static const bool numa_local = false; // a pool per NUMA node, every thread uses the one of its node
+        using backing = HeapBacking; // source of chunk memory, MmapBacking<> commits it lazily
+        using tracer = NoTrace; // receives TraceEvent-s, RingTrace<> keeps them for a later dump
+    };
+
+
+    /**
+     * Memory shared by all copies of one ChunkAllocator: the list owning chunks,
+     * the bins indexing their free tails and the lists of returned blocks.
+     * Every block is rounded up to its size class, so a returned block can serve
+     * any later request of the same class.
+     */
+    template<typename Policy>
+    class ChunkPool {
+    public:
+        using chunk_type = Chunk<Policy::chunk_bytes,
+                (Policy::alignment > alignof(std::max_align_t)) ? Policy::alignment : alignof(std::max_align_t),
+                typename Policy::backing>;
+        using backing = typename Policy::backing;
+
+    private:
+        static const std::size_t MIN_CLASS = log2_ceil(sizeof(void *)); // a block must fit the free list pointer
+
         /**
-         * Adds another node to the tail
+         * Header stored right before every oversized block.
          */
-        Node<T> *add() {
-            auto node = new Node<T>(); // create a node
-            if (!begin) {
-                begin = node;
+        struct LargeBlock {
+            LargeBlock *prev;
+            LargeBlock *next;
+            void *base; // start of the memory from the backing
+            std::size_t bytes; // size of that memory
+            std::size_t align; // its alignment
+            uint64_t number; // blocks are numbered in allocation order
+            const ChunkPool *owner; // pool that allocated the block
+        };
+
+        /**
+         * State of a chunk before its first change after a mark.
+         */
+        struct Saved {
+            chunk_type *chunk;
+            std::size_t used;
+            std::size_t live;
+        };
+
+        ChunkList<chunk_type> chunks;
+        FreeBins<chunk_type> bins;
+        FreeBlocks<chunk_type> blocks;
+        std::size_t empty_chunks = 0; // chunks without live blocks
+        LargeBlock *large = nullptr; // oversized blocks that are still alive, the newest first
+        uint64_t large_count = 0; // oversized blocks allocated so far
+        std::vector<Saved> journal; // chunks changed since the outermost active mark
+        std::size_t marks = 0; // active marks
+        uint64_t epoch = 0; // changes with every mark and rollback
+        using counters_type = ChunkCounters<chunk_type::CLASSES>;
+
+        counters_type counters;
+
+        chunk_type *add_chunk() {
+            if (marks != 0) {
+                journal.reserve(journal.size() + chunks.size + 1); // so save() never throws in deallocate
+            }
+            auto chunk = chunks.add();
+            Policy::tracer::record(TraceEvent::CHUNK_CREATED, chunk->data(), chunk_type::CAPACITY);
+            chunk->owner = this;
+            empty_chunks += 1;
+            counters_type::add(counters.chunks_created, 1);
+            counters_type::add(counters.bytes_committed, chunk->committed_bytes());
+            counters_type::add(counters.tail_bytes, chunk_type::CAPACITY);
+            counters_type::raise(counters.peak_chunks, chunks.size);
+            return chunk;
+        }
+
+        /// Journals chunk before its first change in the current epoch.
+        void save(chunk_type *chunk) {
+            if (marks != 0 && chunk->saved_epoch != epoch) {
+                chunk->saved_epoch = epoch;
+                journal.push_back(Saved{chunk, chunk->get_size_of_used_memory(), chunk->live});
+            }
+        }
+
+        /**
+         * Puts the free tail of chunk back to used bytes and its live blocks to live.
+         * Returned blocks of the chunk are dropped, they may lie in the rewound tail.
+         * The chunk may have been reset and decommitted since, bytes_committed follows what it has now.
+         */
+        void restore(chunk_type *chunk, std::size_t used, std::size_t live) {
+            bins.remove(chunk);
+            blocks.forget(chunk);
+            counters_type::sub(counters.tail_bytes, chunk->get_size_of_free_memory());
+            counters_type::sub(counters.bytes_committed, chunk->committed_bytes());
+            chunk->rewind(used);
+            counters_type::add(counters.bytes_committed, chunk->committed_bytes());
+            counters_type::add(counters.tail_bytes, chunk->get_size_of_free_memory());
+            if (chunk->live == 0 && live != 0) {
+                empty_chunks -= 1;
+            } else if (chunk->live != 0 && live == 0) {
+                empty_chunks += 1;
+            }
+            chunk->live = live;
+            bins.insert(chunk);
+        }
+
+        /// Frees oversized blocks with numbers from first on.
+        void drop_large(uint64_t first) noexcept {
+            while (large != nullptr && large->number >= first) {
+                deallocate_large(reinterpret_cast<uint8_t *>(large + 1));
+            }
+        }
+
+        /// Chunk got its last block back: keep it in the cache or free it.
+        void release(chunk_type *chunk) {
+            bins.remove(chunk);
+            blocks.forget(chunk);
+            counters_type::add(counters.tail_bytes, chunk_type::CAPACITY - chunk->get_size_of_free_memory());
+            counters_type::sub(counters.bytes_committed, chunk->committed_bytes());
+            chunk->reset();
+            counters_type::add(counters.bytes_committed, chunk->committed_bytes());
+            if (empty_chunks < Policy::empty_chunk_cache || marks != 0) { // the journal may point to it
+                empty_chunks += 1;
+                bins.insert(chunk);
             } else {
-                auto it = begin;
-                while (it->next != nullptr) {
-                    it = it->next;
+                Policy::tracer::record(TraceEvent::CHUNK_FREED, chunk->data(), chunk_type::CAPACITY);
+                counters_type::add(counters.chunks_freed, 1);
+                counters_type::sub(counters.tail_bytes, chunk_type::CAPACITY);
+                counters_type::sub(counters.bytes_committed, chunk->committed_bytes());
+                chunks.remove(chunk);
+            }
+        }
+
+    public:
+        /// Size class of a request of bytes.
+        static std::size_t block_class(std::size_t bytes) {
+            std::size_t k = log2_ceil(bytes);
+            return (k < MIN_CLASS) ? MIN_CLASS : k;
+        }
+
+        /// Size of a block of class k.
+        static std::size_t block_bytes(std::size_t k) {
+            std::size_t bytes = std::size_t(1) << k;
+            return (bytes < chunk_type::CAPACITY) ? bytes : chunk_type::CAPACITY;
+        }
+
+        /// Biggest block with alignment align that fits a chunk.
+        static std::size_t max_bytes(std::size_t align) {
+            if (align <= chunk_type::ALIGNMENT) {
+                return chunk_type::CAPACITY;
+            }
+            // the start of a chunk is aligned weaker, so the whole-chunk class can't be used
+            std::size_t lost = align - chunk_type::ALIGNMENT;
+            return (lost < chunk_type::CAPACITY) ? std::size_t(1) << log2_floor(chunk_type::CAPACITY - lost) : 0;
+        }
+
+        /// Number of chunks owned by the pool.
+        std::size_t size() const {
+            return chunks.size;
+        }
+
+        /// Snapshot of the counters, may be taken from any thread.
+        ChunkStats stats() const {
+            return counters.snapshot(chunk_type::CAPACITY);
+        }
+
+        /// Checks that ptr, a block from allocate of some pool, lies in one of the chunks of this pool.
+        bool owns(const uint8_t *ptr) const {
+            return chunk_type::of(ptr)->owner == this;
+        }
+
+        /**
+         * Returns bytes aligned to align for a request that does not fit a chunk.
+         * Every such block gets its own memory with a LargeBlock header in front of it.
+         */
+        uint8_t *allocate_large(std::size_t bytes, std::size_t align) {
+            if (align < alignof(LargeBlock)) {
+                align = alignof(LargeBlock);
+            }
+            std::size_t offset = (sizeof(LargeBlock) + align - 1) / align * align; // header fits before the block
+            if (bytes > std::numeric_limits<std::size_t>::max() - offset) {
+                throw std::bad_alloc();
+            }
+            void *base = backing::reserve(offset + bytes, align);
+            if (backing::lazy_commit) {
+                try {
+                    backing::commit(base, offset + bytes);
+                } catch (...) {
+                    backing::release(base, offset + bytes, align);
+                    throw;
                 }
-                it->next = node;
             }
-            size += 1;
-            return node;
+            auto res = static_cast<uint8_t *>(base) + offset;
+            auto header = reinterpret_cast<LargeBlock *>(res) - 1;
+            header->prev = nullptr;
+            header->next = large;
+            header->base = base;
+            header->bytes = offset + bytes;
+            header->align = align;
+            header->number = large_count++;
+            header->owner = this;
+            if (large != nullptr) {
+                large->prev = header;
+            }
+            large = header;
+            counters_type::add(counters.large_blocks, 1);
+            counters_type::add(counters.large_bytes, header->bytes);
+            return res;
         }
 
-        bool is_empty() {
-            return (size == 0);
+        /// Checks that ptr, an oversized block from allocate_large of some pool, comes from this pool.
+        bool owns_large(const uint8_t *ptr) const {
+            return (reinterpret_cast<const LargeBlock *>(ptr) - 1)->owner == this;
         }
 
+        /// Frees an oversized block from allocate_large.
+        void deallocate_large(uint8_t *ptr) noexcept {
+            auto header = reinterpret_cast<LargeBlock *>(ptr) - 1;
+            if (header->prev != nullptr) {
+                header->prev->next = header->next;
+            } else {
+                large = header->next;
+            }
+            if (header->next != nullptr) {
+                header->next->prev = header->prev;
+            }
+            counters_type::sub(counters.large_blocks, 1);
+            counters_type::sub(counters.large_bytes, header->bytes);
+            backing::release(header->base, header->bytes, header->align);
+        }
 
-        ~SimpleList() {
-#ifdef DEBUG
-            std::cout << "~SimpleList() at" << this << std::endl;
-#endif
-            if (begin != nullptr) {
-                auto it = begin;
-                while (it->next != nullptr) {
-                    auto tmp = it->next;
-                    delete it;
-                    it = tmp;
+        /**
+         * Returns bytes aligned to align: a returned block of the same class if there is one,
+         * otherwise a block carved from the free tail of some chunk.
+         */
+        uint8_t *allocate(std::size_t bytes, std::size_t align) {
+            std::size_t k = block_class(bytes);
+            chunk_type *chunk = nullptr;
+            uint8_t *res = blocks.pop(k, align, chunk);
+            if (res == nullptr) {
+                std::size_t block = block_bytes(k);
+                std::size_t failed_probes = 0;
+                chunk = bins.find(block, align, failed_probes);
+                counters_type::add(counters.failed_probes, failed_probes);
+                if (chunk != nullptr) {
+                    bins.remove(chunk);
+                } else {
+                    chunk = add_chunk();
                 }
-                delete it; // delete tail
+                save(chunk);
+                std::size_t padding = chunk->padding(align);
+                std::size_t committed = chunk->committed_bytes();
+                res = chunk->allocate(block, align);
+                counters_type::add(counters.bytes_committed, chunk->committed_bytes() - committed);
+                bins.insert(chunk); // rebin by the space that is left
+                counters_type::add(counters.padding_bytes, padding);
+                counters_type::sub(counters.tail_bytes, padding + block);
+            } else {
+                save(chunk);
+                counters_type::add(counters.reused_blocks, 1);
+            }
+            if (chunk->live == 0) {
+                empty_chunks -= 1;
             }
+            chunk->live += 1;
+            counters_type::add(counters.allocations[k], 1);
+            counters_type::add(counters.bytes_in_use, block_bytes(k));
+            counters_type::raise(counters.peak_bytes_in_use, counters.bytes_in_use.load(std::memory_order_relaxed));
+            return res;
+        }
+
+        /**
+         * Takes back block of bytes at ptr. The last carved block goes back to the free tail,
+         * the others are put on the free list of their class.
+         */
+        void deallocate(uint8_t *ptr, std::size_t bytes) noexcept {
+            auto chunk = chunk_type::of(ptr);
+            std::size_t k = block_class(bytes);
+            save(chunk);
+            counters_type::sub(counters.bytes_in_use, block_bytes(k));
+            chunk->live -= 1;
+            if (chunk->live == 0) {
+                release(chunk);
+                return;
+            }
+            if (chunk->is_last(ptr, block_bytes(k))) {
+                bins.remove(chunk);
+                std::size_t free_bytes = chunk->get_size_of_free_memory();
+                chunk->give_back(ptr);
+                counters_type::add(counters.tail_bytes, chunk->get_size_of_free_memory() - free_bytes);
+                bins.insert(chunk);
+            } else {
+                blocks.push(chunk, k, ptr);
+            }
+        }
+
+        /**
+         * Point in the life of a pool that rollback() returns to.
+         */
+        struct Mark {
+            std::size_t journal; // journal entries made before the mark
+            std::size_t marks; // marks active before it
+            uint64_t large_count; // oversized blocks allocated before it
+            uint64_t bytes_in_use;
+        };
+
+        /**
+         * Starts journaling chunks as they change, so that rollback() touches only those.
+         * Chunks are not freed while a mark is active.
+         */
+        Mark mark() {
+            journal.reserve(journal.size() + chunks.size); // so save() never throws in deallocate
+            Mark res{journal.size(), marks, large_count, counters.bytes_in_use.load(std::memory_order_relaxed)};
+            marks += 1;
+            epoch += 1;
+            return res;
+        }
+
+        /**
+         * Throws away every block allocated after m, in O(chunks changed since m).
+         * Blocks that were allocated before m and freed after it stay allocated until reset(),
+         * returned blocks of the rewound chunks are not reused until then either.
+         * m stays active, marks taken after it are invalidated.
+         */
+        void rollback(const Mark &m) noexcept {
+            Policy::tracer::record(TraceEvent::ROLLBACK, this, journal.size() - m.journal);
+            while (journal.size() > m.journal) {
+                const Saved &saved = journal.back(); // the oldest state of a chunk is restored last
+                restore(saved.chunk, saved.used, saved.live);
+                journal.pop_back();
+            }
+            drop_large(m.large_count);
+            counters_type::sub(counters.bytes_in_use, counters.bytes_in_use.load(std::memory_order_relaxed));
+            counters_type::add(counters.bytes_in_use, m.bytes_in_use);
+            marks = m.marks + 1;
+            epoch += 1;
+        }
+
+        /**
+         * Throws away every block and invalidates all marks.
+         * Chunks are kept with their committed memory, ready for the next round.
+         */
+        void reset() noexcept {
+            Policy::tracer::record(TraceEvent::RESET, this, chunks.size);
+            for (auto chunk = chunks.begin; chunk != nullptr; chunk = chunk->next) {
+                restore(chunk, 0, 0);
+            }
+            drop_large(0);
+            counters_type::sub(counters.bytes_in_use, counters.bytes_in_use.load(std::memory_order_relaxed));
+            journal.clear();
+            marks = 0;
+            epoch += 1;
+        }
+
+        ChunkPool() = default;
+
+        ChunkPool(const ChunkPool &) = delete;
+
+        ChunkPool &operator=(const ChunkPool &) = delete;
+
+        ~ChunkPool() {
+            while (large != nullptr) {
+                auto header = large;
+                large = large->next;
+                backing::release(header->base, header->bytes, header->align);
+            }
+        }
+    };
+
+
+    /**
+     * ChunkPool for allocators used from many threads.
+     * Every thread keeps a magazine of blocks per size class, so most calls touch only
+     * thread-local memory. Behind the magazines the pool is split into Policy::pool_shards
+     * ChunkPool-s, each behind its own lock. A thread refills its magazines from its home shard,
+     * assigned round-robin when it first uses the pool, so threads refilling at once rarely
+     * meet on a lock. A block goes back to the shard that owns it, the home shard is checked first.
+     * The magazines of a thread are flushed back when the thread exits.
+     */
+    template<typename Policy>
+    class ConcurrentChunkPool {
+    public:
+        using chunk_type = typename ChunkPool<Policy>::chunk_type;
+
+    private:
+        static const std::size_t MAGAZINE = 32; // blocks per size class kept by a thread
+        static const std::size_t SHARDS = (Policy::pool_shards > 0) ? Policy::pool_shards : 1;
+        static const std::size_t CACHE_LINE = 64;
+
+        struct Magazine {
+            uint8_t *blocks[MAGAZINE];
+            std::size_t size = 0;
+        };
+
+        /**
+         * Link from the caches of all threads to their pool. It outlives the pool:
+         * the pool destructor sets pool to nullptr, a thread flushing its caches checks it under mutex.
+         */
+        struct Registry {
+            std::mutex mutex;
+            ConcurrentChunkPool *pool;
+        };
+
+        /// Magazines of one thread for one pool, given back to the pool when the thread exits.
+        struct ThreadCache {
+            Magazine magazines[chunk_type::CLASSES];
+            std::size_t home = 0; // shard to refill from
+            std::shared_ptr<Registry> registry;
+
+            ThreadCache() = default;
+
+            ThreadCache(const ThreadCache &) = delete;
+
+            ThreadCache &operator=(const ThreadCache &) = delete;
+
+            ~ThreadCache() {
+                if (registry == nullptr) {
+                    return;
+                }
+                std::lock_guard<std::mutex> lock(registry->mutex);
+                if (registry->pool != nullptr) {
+                    registry->pool->drain(*this);
+                }
+            }
+        };
+
+        /// Caches of one thread by pool id, the last used one is remembered.
+        struct LocalCaches {
+            std::unordered_map<uint64_t, ThreadCache> caches;
+            uint64_t last_id = ~uint64_t(0);
+            ThreadCache *last = nullptr;
+        };
+
+        struct alignas(CACHE_LINE) Shard {
+            ChunkPool<Policy> pool;
+            std::mutex mutex; // guards pool
+        };
+
+        Shard shards[SHARDS];
+        std::atomic<std::size_t> homes{0}; // home shards handed out so far
+        std::shared_ptr<Registry> registry;
+        const uint64_t id; // never reused, so a cache of a destroyed pool is never touched again
+
+        static uint64_t next_id() {
+            static std::atomic<uint64_t> ids(0);
+            return ids.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        static LocalCaches &locals() {
+            static thread_local LocalCaches local;
+            return local;
+        }
+
+        /// Drops the caches of destroyed pools, their blocks went away with the pools.
+        static void prune(LocalCaches &local) {
+            for (auto it = local.caches.begin(); it != local.caches.end();) {
+                bool alive;
+                {
+                    std::lock_guard<std::mutex> lock(it->second.registry->mutex);
+                    alive = it->second.registry->pool != nullptr;
+                }
+                if (alive) {
+                    ++it;
+                    continue;
+                }
+                if (local.last == &it->second) {
+                    local.last_id = ~uint64_t(0);
+                    local.last = nullptr;
+                }
+                it = local.caches.erase(it);
+            }
+        }
+
+        ThreadCache &local_cache() {
+            LocalCaches &local = locals();
+            if (local.last_id != id) {
+                auto found = local.caches.find(id);
+                if (found == local.caches.end()) {
+                    prune(local);
+                    found = local.caches.try_emplace(id).first;
+                    found->second.home = homes.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+                    found->second.registry = registry;
+                }
+                local.last = &found->second;
+                local.last_id = id;
+            }
+            return *local.last;
+        }
+
+        /// Blocks of class k moved between a magazine and the pool at once.
+        static std::size_t batch(std::size_t k) {
+            std::size_t blocks = chunk_type::CAPACITY / (4 * ChunkPool<Policy>::block_bytes(k));
+            return (blocks < 1) ? 1 : (blocks > MAGAZINE / 2) ? MAGAZINE / 2 : blocks;
+        }
+
+        void refill(Magazine &magazine, std::size_t k, std::size_t align, std::size_t home) {
+            Shard &shard = shards[home];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (std::size_t i = batch(k); i > 0; --i) {
+                magazine.blocks[magazine.size] = shard.pool.allocate(ChunkPool<Policy>::block_bytes(k), align);
+                magazine.size += 1;
+            }
+        }
+
+        /**
+         * Returns count blocks of class k to the shards owning them, starting with home.
+         * Every shard is locked once. The order of blocks is not kept.
+         */
+        void give_back(uint8_t **blocks, std::size_t count, std::size_t k, std::size_t home) noexcept {
+            for (std::size_t i = 0; i < SHARDS && count > 0; ++i) {
+                Shard &shard = shards[(home + i) % SHARDS];
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                for (std::size_t j = 0; j < count;) {
+                    if (shard.pool.owns(blocks[j])) {
+                        shard.pool.deallocate(blocks[j], ChunkPool<Policy>::block_bytes(k));
+                        count -= 1;
+                        blocks[j] = blocks[count];
+                    } else {
+                        ++j;
+                    }
+                }
+            }
+            assert(count == 0 && "ConcurrentChunkPool: block not owned by any shard");
+        }
+
+        /// Returns the oldest batch of the magazine to the pool.
+        void flush(Magazine &magazine, std::size_t k, std::size_t home) noexcept {
+            std::size_t count = batch(k);
+            give_back(magazine.blocks, count, k, home);
+            std::copy(magazine.blocks + count, magazine.blocks + magazine.size, magazine.blocks);
+            magazine.size -= count;
+        }
+
+        /// Returns all blocks of a thread cache to the pool.
+        void drain(ThreadCache &cache) noexcept {
+            for (std::size_t k = 0; k < chunk_type::CLASSES; ++k) {
+                Magazine &magazine = cache.magazines[k];
+                give_back(magazine.blocks, magazine.size, k, cache.home);
+                magazine.size = 0;
+            }
+        }
+
+    public:
+        ConcurrentChunkPool() : registry(std::make_shared<Registry>()), id(next_id()) {
+            registry->pool = this;
+        }
+
+        ConcurrentChunkPool(const ConcurrentChunkPool &) = delete;
+
+        ConcurrentChunkPool &operator=(const ConcurrentChunkPool &) = delete;
+
+        static std::size_t max_bytes(std::size_t align) {
+            return ChunkPool<Policy>::max_bytes(align);
+        }
+
+        /// Number of shards the pool is split into.
+        static std::size_t shard_count() {
+            return SHARDS;
+        }
+
+        /// Number of chunks of all shards.
+        std::size_t size() {
+            std::size_t res = 0;
+            for (auto &shard: shards) {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                res += shard.pool.size();
+            }
+            return res;
+        }
+
+        /// Counters of all shards added up, without locking. Blocks in thread magazines count as in use.
+        ChunkStats stats() const {
+            ChunkStats res = shards[0].pool.stats();
+            for (std::size_t i = 1; i < SHARDS; ++i) {
+                res += shards[i].pool.stats();
+            }
+            return res;
+        }
+
+        uint8_t *allocate_large(std::size_t bytes, std::size_t align) {
+            Shard &shard = shards[local_cache().home];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            return shard.pool.allocate_large(bytes, align);
+        }
+
+        /// Frees an oversized block in its shard. The owner is found without locking, the header never changes.
+        void deallocate_large(uint8_t *ptr) noexcept {
+            for (auto &shard: shards) {
+                if (shard.pool.owns_large(ptr)) {
+                    std::lock_guard<std::mutex> lock(shard.mutex);
+                    shard.pool.deallocate_large(ptr);
+                    return;
+                }
+            }
+            assert(false && "ConcurrentChunkPool: block not owned by any shard");
+        }
+
+        uint8_t *allocate(std::size_t bytes, std::size_t align) {
+            std::size_t k = ChunkPool<Policy>::block_class(bytes);
+            ThreadCache &cache = local_cache();
+            Magazine &magazine = cache.magazines[k];
+            if (magazine.size == 0) {
+                refill(magazine, k, align, cache.home);
+            }
+            uint8_t *block = magazine.blocks[magazine.size - 1];
+            if (reinterpret_cast<uintptr_t>(block) % align != 0) { // cached for a weaker aligned type
+                Shard &shard = shards[cache.home];
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                return shard.pool.allocate(bytes, align);
+            }
+            magazine.size -= 1;
+            return block;
+        }
+
+        void deallocate(uint8_t *ptr, std::size_t bytes) noexcept {
+            std::size_t k = ChunkPool<Policy>::block_class(bytes);
+            ThreadCache &cache = local_cache();
+            Magazine &magazine = cache.magazines[k];
+            if (magazine.size == 2 * batch(k)) {
+                flush(magazine, k, cache.home);
+            }
+            magazine.blocks[magazine.size] = ptr;
+            magazine.size += 1;
+        }
+
+        /**
+         * Blocks still in magazines of other threads go away with the shards,
+         * those threads drop their caches of this pool the next time they start using a new pool.
+         */
+        ~ConcurrentChunkPool() {
+            {
+                std::lock_guard<std::mutex> lock(registry->mutex);
+                registry->pool = nullptr;
+            }
+            LocalCaches &local = locals();
+            local.caches.erase(id);
+            if (local.last_id == id) {
+                local.last_id = ~uint64_t(0);
+                local.last = nullptr;
+            }
+        }
+    };
+
+
+    /**
+     * ChunkPool per NUMA node, each behind its own lock.
+     * A thread allocates from the pool of the node it runs on, and chunks made for that
+     * pool are reserved with numa_target() set to the node, so NumaBacking binds them there.
+     * A block is returned to the pool that owns it, the pool of the calling node is checked first.
+     * Oversized blocks are kept by the pool of the calling node too.
+     * With one node this is a ChunkPool behind a mutex.
+     */
+    template<typename Policy>
+    class NumaChunkPool {
+    public:
+        using chunk_type = typename ChunkPool<Policy>::chunk_type;
+
+    private:
+        struct NodePool {
+            ChunkPool<Policy> pool;
+            std::mutex mutex; // guards pool
+        };
+
+        const std::size_t count; // NUMA nodes
+        std::unique_ptr<NodePool[]> nodes;
+
+        std::size_t local_node() const {
+            return static_cast<std::size_t>(current_numa_node()) % count;
+        }
+
+    public:
+        NumaChunkPool() : count(numa_nodes()), nodes(new NodePool[count]) {}
+
+        NumaChunkPool(const NumaChunkPool &) = delete;
+
+        NumaChunkPool &operator=(const NumaChunkPool &) = delete;
+
+        static std::size_t max_bytes(std::size_t align) {
+            return ChunkPool<Policy>::max_bytes(align);
+        }
+
+        /// Number of NUMA nodes with a pool.
+        std::size_t node_count() const {
+            return count;
+        }
+
+        /// Number of chunks of all nodes.
+        std::size_t size() {
+            std::size_t res = 0;
+            for (std::size_t node = 0; node < count; ++node) {
+                std::lock_guard<std::mutex> lock(nodes[node].mutex);
+                res += nodes[node].pool.size();
+            }
+            return res;
+        }
+
+        /// Counters of all nodes added up, see ChunkStats::operator+=.
+        ChunkStats stats() const {
+            ChunkStats res = nodes[0].pool.stats();
+            for (std::size_t node = 1; node < count; ++node) {
+                res += nodes[node].pool.stats();
+            }
+            return res;
+        }
+
+        /// Counters of the pool of one node.
+        ChunkStats node_stats(std::size_t node) const {
+            return nodes[node].pool.stats();
+        }
+
+        uint8_t *allocate_large(std::size_t bytes, std::size_t align) {
+            std::size_t node = local_node();
+            NumaTarget target(static_cast<int>(node));
+            std::lock_guard<std::mutex> lock(nodes[node].mutex);
+            return nodes[node].pool.allocate_large(bytes, align);
+        }
+
+        /// Frees an oversized block in the pool that owns it, the pool of the calling node is checked first.
+        void deallocate_large(uint8_t *ptr) noexcept {
+            std::size_t local = local_node();
+            for (std::size_t i = 0; i < count; ++i) {
+                NodePool &node = nodes[(local + i) % count];
+                if (node.pool.owns_large(ptr)) { // the header never changes, no lock is needed to read it
+                    std::lock_guard<std::mutex> lock(node.mutex);
+                    node.pool.deallocate_large(ptr);
+                    return;
+                }
+            }
+            assert(false && "NumaChunkPool: pointer not owned by any node");
+        }
+
+        uint8_t *allocate(std::size_t bytes, std::size_t align) {
+            std::size_t node = local_node();
+            NumaTarget target(static_cast<int>(node));
+            std::lock_guard<std::mutex> lock(nodes[node].mutex);
+            return nodes[node].pool.allocate(bytes, align);
+        }
+
+        void deallocate(uint8_t *ptr, std::size_t bytes) noexcept {
+            std::size_t local = local_node();
+            for (std::size_t i = 0; i < count; ++i) {
+                NodePool &node = nodes[(local + i) % count];
+                std::lock_guard<std::mutex> lock(node.mutex);
+                if (node.pool.owns(ptr)) {
+                    node.pool.deallocate(ptr, bytes);
+                    return;
+                }
+            }
+            assert(false && "NumaChunkPool: pointer not owned by any node");
         }
     };
 
@@ -172,50 +1227,108 @@ namespace task {
     /**
      Custom Allocator with chunks.
      */
-    template<typename T>
+    template<typename T, typename Policy = DefaultChunkPolicy>
     class ChunkAllocator {
     private:
-        static const long MAX_BYTES = 100; //bytes
-        SimpleList<Chunk<MAX_BYTES>> *lst = nullptr; // list of chunks
-        long *self_counter;
+        template<typename U, typename P>
+        friend class ChunkAllocator;
+
+        static const std::size_t ALIGNMENT = (Policy::alignment > alignof(T)) ? Policy::alignment : alignof(T);
+        static_assert((ALIGNMENT & (ALIGNMENT - 1)) == 0, "ChunkAllocator: alignment must be a power of two");
+
+        using pool_type = typename std::conditional<Policy::numa_local, NumaChunkPool<Policy>,
+                typename std::conditional<Policy::thread_safe,
+                        ConcurrentChunkPool<Policy>, ChunkPool<Policy>>::type>::type;
+
+        static const bool SINGLE_THREADED = !Policy::thread_safe && !Policy::numa_local;
+
+        pool_type *lst = nullptr; // chunks, their free space and returned blocks
+        std::atomic<long> *self_counter; // number of consumers of lst
+
+        using tracer = typename Policy::tracer;
 
     public:
         using value_type = T;
         using pointer = T *;
         using const_pointer = const T *;
         using reference = T &;
-        using difference_type = int; // signed
+        using difference_type = std::ptrdiff_t; // signed
         using const_reference = const T &;
         using size_type = std::size_t;
         template<class U>
         struct rebind {
-            typedef ChunkAllocator<U> other;
+            typedef ChunkAllocator<U, Policy> other;
         };
 
+        // Copies share one pool, so it follows the memory when containers are copied, moved or swapped.
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+        using is_always_equal = std::false_type;
+
     public:
-        ChunkAllocator() : lst(new SimpleList<Chunk<MAX_BYTES>>()), self_counter(new long(1)) {
-#ifdef DEBUG
-            self_report("constructor ChunkAllocator()");
-#endif
+        ChunkAllocator() : lst(new pool_type()), self_counter(new std::atomic<long>(1)) {
+            tracer::record(TraceEvent::ALLOCATOR_CREATED, lst);
         };
 
 
-        ChunkAllocator(const ChunkAllocator &other) {
-#ifdef DEBUG
-            self_report("copy-constructor ChunkAllocator()");
-#endif
-            if (this != &other and this->lst != other.lst) {
-                this->lst = other.lst;
-                this->self_counter = other.self_counter;
-                *this->self_counter += 1;
-            }
-            std::cout << "with self_counter " << *this->self_counter << std::endl;
+        ChunkAllocator(const ChunkAllocator &other) : lst(other.lst), self_counter(other.self_counter) {
+            tracer::record(TraceEvent::ALLOCATOR_COPIED, other.lst);
+            this->self_counter->fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * Rebound copy: allocators of different value types built from one another
+         * share the same pool, e.g. a container and its nodes.
+         */
+        template<typename U>
+        ChunkAllocator(const ChunkAllocator<U, Policy> &other) : lst(other.lst), self_counter(other.self_counter) {
+            tracer::record(TraceEvent::ALLOCATOR_COPIED, other.lst);
+            this->self_counter->fetch_add(1, std::memory_order_relaxed);
         }
 
         ChunkAllocator &operator=(ChunkAllocator const &other);
 
-        size_t max_size() {
-            return MAX_BYTES / sizeof(T);
+        /// Position in the pool to return to with rollback().
+        using mark_type = typename ChunkPool<Policy>::Mark;
+
+        /**
+         * Remembers the state of the pool shared by all copies.
+         * Only for allocators that are neither thread_safe nor numa_local.
+         */
+        mark_type mark() {
+            static_assert(SINGLE_THREADED, "ChunkAllocator: mark() needs a single-threaded pool");
+            return lst->mark();
+        }
+
+        /**
+         * Frees at once everything allocated through any copy after m without deallocate calls.
+         * Blocks from after m must not be used or deallocated any more.
+         */
+        void rollback(const mark_type &m) noexcept {
+            static_assert(SINGLE_THREADED, "ChunkAllocator: rollback() needs a single-threaded pool");
+            lst->rollback(m);
+        }
+
+        /// Frees at once everything allocated through any copy, keeping the chunks for reuse.
+        void reset() noexcept {
+            static_assert(SINGLE_THREADED, "ChunkAllocator: reset() needs a single-threaded pool");
+            lst->reset();
+        }
+
+        size_t max_size() const {
+            return std::numeric_limits<size_type>::max() / sizeof(T);
+        }
+
+        /// Checks that other hands out memory from the same pool.
+        template<typename U>
+        bool same_pool(const ChunkAllocator<U, Policy> &other) const noexcept {
+            return this->lst == other.lst;
+        }
+
+        /// Counters of the pool shared by all copies of this allocator.
+        ChunkStats stats() const {
+            return lst->stats();
         }
 
         /**
@@ -224,116 +1337,88 @@ namespace task {
          * @return pointer to allocated memory.
          */
         pointer allocate(size_type n) {
-#ifdef DEBUG
-            self_report("Allocating items");
-#endif
-            if (n > max_size()) { // Request capacity more than Chunk::CHUNK_SIZE
-                std::cout << "Request amount of memory more than " << MAX_BYTES << " bytes." << std::endl;
+            if (n > max_size()) {
+                tracer::record(TraceEvent::BAD_ALLOC, lst, n);
                 throw std::bad_alloc();
             }
-            if (lst->is_empty()) {// If list of chunks is empty add chunk.
-                lst->add();
-            }
-            bool found = false; // indicates free space in existed chunks
-            pointer res; // pointer to result
-            /**
-             * Add n elements. Pass through the list to find free place in existed chunks.
-            */
-            auto it = lst->begin;
-            auto chunk = it->data;
-            while (true) {
-                if (n * sizeof(T) < chunk->get_size_of_free_memory()) {
-                    res = reinterpret_cast<T *>(chunk->allocate(n * sizeof(T)));
-                    found = true;
-                    break;
-                }
-                if (it->next == nullptr) {
-                    break;
-                }
-                it = it->next;
-                chunk = it->data;
-            }
-            /**
-             * In case: we didn't find any free place in existed chunks. Create a new chunk.
-             */
-            if (!found) {
-                auto last_node = lst->add();
-                chunk = last_node->data;
-                res = reinterpret_cast<T *>(chunk->allocate(n * sizeof(T)));
+            pointer res;
+            if (n > max_chunk_size()) { // Request capacity more than Chunk::CHUNK_SIZE
+                res = reinterpret_cast<T *>(lst->allocate_large(n * sizeof(T), ALIGNMENT));
+            } else {
+                res = reinterpret_cast<T *>(lst->allocate(n * sizeof(T), ALIGNMENT));
             }
+            tracer::record(TraceEvent::ALLOCATE, res, n * sizeof(T));
             return res;
         } // allocate()
 
 
         void deallocate(pointer p, size_type n) noexcept {
-#ifdef DEBUG
-            self_report("Allocator : deallocate");
-#endif
+            tracer::record(TraceEvent::DEALLOCATE, p, n * sizeof(T));
+            if (n > max_chunk_size()) {
+                lst->deallocate_large(reinterpret_cast<uint8_t *>(p));
+            } else {
+                lst->deallocate(reinterpret_cast<uint8_t *>(p), n * sizeof(T));
+            }
         }
 
 
-        template<typename ... Args>
-        void construct(pointer p, Args &&... args) {
-#ifdef DEBUG
-            self_report("construct ChunkAllocator");
-#endif
-            new(p) T(args...); // new - placement function
+        template<typename U, typename ... Args>
+        void construct(U *p, Args &&... args) {
+            tracer::record(TraceEvent::CONSTRUCT, p, sizeof(U));
+            new(p) U(std::forward<Args>(args)...); // new - placement function
         }
 
-        void destroy(pointer p) {
-#ifdef DEBUG
-            self_report("destroy ChunkAllocator");
-#endif
-            p->~T();
+        template<typename U>
+        void destroy(U *p) {
+            tracer::record(TraceEvent::DESTROY, p, sizeof(U));
+            p->~U();
         }
 
         ~ChunkAllocator() {
-#ifdef DEBUG
-            self_report("~ChunkAllocator()");
-#endif
-            if (*this->self_counter == 1) {
-                delete this->lst;
-                delete this->self_counter;
-            } else {
-                *this->self_counter -= 1;
-            }
+            tracer::record(TraceEvent::ALLOCATOR_DESTROYED, lst);
+            release_pool();
         }
 
     private:
 
-        void report(pointer p, size_type n, bool alloc = true) {
-            std::cout << (alloc ? "Alloc: " : "Dealloc: ") << sizeof(T) * n
-                      << " bytes at " << std::hex << std::showbase
-                      << reinterpret_cast<void *>(p) << std::dec << std::endl;
+        /// Number of elements that still fit a chunk, bigger requests take the large-object path.
+        static size_type max_chunk_size() {
+            return pool_type::max_bytes(ALIGNMENT) / sizeof(T);
         }
 
-
-        void self_report(const char *text = "") {
-            std::cout << "i'm at " << this << " : " << this->lst << " : " << text << std::endl;
+        /// Drops this consumer of the pool, the last one deletes it.
+        void release_pool() {
+            if (this->self_counter->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                delete this->lst;
+                delete this->self_counter;
+            }
         }
     }; // ChunkAllocator<>
 
 
-    template<typename T>
-    ChunkAllocator<T> &ChunkAllocator<T>::operator=(const ChunkAllocator<T> &other) {
-#ifdef DEBUG
-        std::cout << "i'm at " << this << " : " << this->lst << " : copy-operator " << std::endl;
-#endif
+    template<typename T, typename Policy>
+    ChunkAllocator<T, Policy> &ChunkAllocator<T, Policy>::operator=(const ChunkAllocator<T, Policy> &other) {
+        tracer::record(TraceEvent::ALLOCATOR_COPIED, other.lst);
         if (this != &other and this->lst != other.lst) {
-            if (*this->self_counter == 1) {
-                delete this->lst;
-                delete this->self_counter;
-            } else {
-                *this->self_counter -= 1;
-            }
+            other.self_counter->fetch_add(1, std::memory_order_relaxed);
+            release_pool();
             this->lst = other.lst;
             this->self_counter = other.self_counter;
-            *this->self_counter += 1;
         }
-        std::cout << "with self_counter " << *this->self_counter << std::endl;
         return *this;
     }
 
+    /// Allocators are equal when they share a pool, so one can free what the other allocated.
+    template<typename T, typename U, typename Policy>
+    bool operator==(const ChunkAllocator<T, Policy> &a, const ChunkAllocator<U, Policy> &b) noexcept {
+        return a.same_pool(b);
+    }
+
+    template<typename T, typename U, typename Policy>
+    bool operator!=(const ChunkAllocator<T, Policy> &a, const ChunkAllocator<U, Policy> &b) noexcept {
+        return !(a == b);
+    }
+
 } // namespace task
 
 
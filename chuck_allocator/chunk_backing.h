@@ -0,0 +1,220 @@
+#ifndef HW_5_ALLOCATOR_CHUNK_BACKING_H
+#define HW_5_ALLOCATOR_CHUNK_BACKING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <new>
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+namespace task {
+
+    /**
+     * Where Chunk and the large-object path get their memory from.
+     * A backing reserves address space, commits it before use, decommits memory
+     * of emptied chunks and finally releases it:
+     *     static void *reserve(std::size_t bytes, std::size_t align);
+     *     static void commit(void *p, std::size_t bytes);
+     *     static void decommit(void *p, std::size_t bytes) noexcept;
+     *     static void release(void *p, std::size_t bytes, std::size_t align) noexcept;
+     * With lazy_commit == false reserved memory is usable at once and commit is never called.
+     */
+
+    /**
+     * Memory from the aligned operator new, committed by the system on first touch.
+     */
+    struct HeapBacking {
+        static const bool lazy_commit = false;
+        static const std::size_t commit_step = 0;
+
+        static void *reserve(std::size_t bytes, std::size_t align) {
+            return ::operator new(bytes, std::align_val_t(align));
+        }
+
+        static void commit(void *, std::size_t) {}
+
+        static void decommit(void *, std::size_t) noexcept {}
+
+        static void release(void *p, std::size_t, std::size_t align) noexcept {
+            ::operator delete(p, std::align_val_t(align));
+        }
+    };
+
+
+    /**
+     * Anonymous mmap: reserving is only an address-space mapping without access,
+     * pages get read/write access in commit_step pieces as a chunk is carved,
+     * and MADV_DONTNEED gives the pages of an emptied chunk back to the system.
+     * With HugePages the mappings are 2 MiB aligned and backed by MAP_HUGETLB pages
+     * when the system has them reserved, otherwise transparent huge pages are requested.
+     */
+    template<bool HugePages = false>
+    struct MmapBacking {
+        static const std::size_t HUGE_PAGE = std::size_t(2) << 20;
+
+        static const bool lazy_commit = true;
+        static const std::size_t commit_step = HugePages ? HUGE_PAGE : std::size_t(64) << 10;
+
+        static std::size_t page_size() {
+            static const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+            return page;
+        }
+
+        static std::size_t round_up(std::size_t bytes, std::size_t step) {
+            return (bytes + step - 1) / step * step;
+        }
+
+        static void *reserve(std::size_t bytes, std::size_t align) {
+            if (HugePages && align < HUGE_PAGE) {
+                align = HUGE_PAGE;
+            }
+            if (align < page_size()) {
+                align = page_size();
+            }
+            bytes = round_up(bytes, page_size());
+#ifdef MAP_HUGETLB
+            if (HugePages && bytes % HUGE_PAGE == 0) {
+                // no MAP_NORESERVE: without free huge pages mmap must fail here, not fault later
+                void *p = mmap(nullptr, bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if (p != MAP_FAILED) {
+                    return p; // hugetlb mappings are aligned to the huge page
+                }
+            }
+#endif
+            // map more than needed and trim both ends to get the alignment
+            std::size_t mapped = bytes + align - page_size();
+            void *p = mmap(nullptr, mapped, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (p == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            auto start = reinterpret_cast<uintptr_t>(p);
+            auto aligned = (start + align - 1) / align * align;
+            if (aligned != start) {
+                munmap(p, aligned - start);
+            }
+            if (aligned + bytes != start + mapped) {
+                munmap(reinterpret_cast<void *>(aligned + bytes), start + mapped - aligned - bytes);
+            }
+#ifdef MADV_HUGEPAGE
+            if (HugePages) {
+                madvise(reinterpret_cast<void *>(aligned), bytes, MADV_HUGEPAGE);
+            }
+#endif
+            return reinterpret_cast<void *>(aligned);
+        }
+
+        static void commit(void *p, std::size_t bytes) {
+            if (mprotect(p, round_up(bytes, page_size()), PROT_READ | PROT_WRITE) != 0) {
+                throw std::bad_alloc();
+            }
+        }
+
+        static void decommit(void *p, std::size_t bytes) noexcept {
+            bytes = round_up(bytes, page_size());
+            madvise(p, bytes, MADV_DONTNEED);
+            mprotect(p, bytes, PROT_NONE);
+        }
+
+        static void release(void *p, std::size_t bytes, std::size_t) noexcept {
+            munmap(p, round_up(bytes, page_size()));
+        }
+    };
+
+
+
+    /// NUMA node of the CPU the calling thread runs on, 0 when the system does not tell.
+    inline int current_numa_node() {
+        unsigned cpu = 0;
+        unsigned node = 0;
+        if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) {
+            return 0;
+        }
+        return static_cast<int>(node);
+    }
+
+    /// Number of possible NUMA nodes, 1 without NUMA support.
+    inline int numa_nodes() {
+        static const int nodes = []() {
+            int first = 0;
+            int last = 0;
+            FILE *possible = std::fopen("/sys/devices/system/node/possible", "r"); // "0" or "0-1"
+            if (possible == nullptr) {
+                return 1;
+            }
+            int read = std::fscanf(possible, "%d-%d", &first, &last);
+            std::fclose(possible);
+            return (read == 2 && last > 0) ? last + 1 : 1;
+        }();
+        return nodes;
+    }
+
+    /// Node the calling thread wants its next reservations on, -1 for the node it runs on.
+    inline int &numa_target() {
+        static thread_local int node = -1;
+        return node;
+    }
+
+    /**
+     * Sets numa_target() for the lifetime of the object.
+     */
+    class NumaTarget {
+    private:
+        int previous;
+
+    public:
+        explicit NumaTarget(int node) : previous(numa_target()) {
+            numa_target() = node;
+        }
+
+        NumaTarget(const NumaTarget &) = delete;
+
+        NumaTarget &operator=(const NumaTarget &) = delete;
+
+        ~NumaTarget() {
+            numa_target() = previous;
+        }
+    };
+
+
+    /**
+     * MmapBacking whose reservations are bound to one NUMA node with mbind.
+     * Node >= 0 binds every reservation to that node strictly. With Node == -1 the node
+     * is numa_target() or the one the calling thread runs on, and is only preferred,
+     * so a full node spills over instead of failing.
+     * Where mbind is not available (no NUMA in the kernel, a sandbox) the binding is
+     * skipped: pages then land on the node of the thread that first touches them.
+     */
+    template<int Node = -1, bool HugePages = false>
+    struct NumaBacking : MmapBacking<HugePages> {
+        /// Places bytes at p on node, returns false when the system refuses.
+        static bool bind(void *p, std::size_t bytes, int node, int mode) noexcept {
+            const std::size_t BITS = 8 * sizeof(unsigned long);
+            unsigned long mask[4] = {};
+            if (node < 0 || static_cast<std::size_t>(node) >= BITS * 4) {
+                return false;
+            }
+            mask[node / BITS] = 1ul << (node % BITS);
+            return syscall(SYS_mbind, p, bytes, mode, mask, BITS * 4, 0) == 0;
+        }
+
+        static void *reserve(std::size_t bytes, std::size_t align) {
+            void *p = MmapBacking<HugePages>::reserve(bytes, align);
+            bytes = MmapBacking<HugePages>::round_up(bytes, MmapBacking<HugePages>::page_size());
+            if (Node >= 0) {
+                bind(p, bytes, Node, MPOL_BIND);
+            } else {
+                bind(p, bytes, (numa_target() >= 0) ? numa_target() : current_numa_node(), MPOL_PREFERRED);
+            }
+            return p;
+        }
+    };
+
+} // namespace task
+
+
+#endif //HW_5_ALLOCATOR_CHUNK_BACKING_H
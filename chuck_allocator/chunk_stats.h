@@ -0,0 +1,165 @@
+#ifndef HW_5_ALLOCATOR_CHUNK_STATS_H
+#define HW_5_ALLOCATOR_CHUNK_STATS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace task {
+
+    /**
+     * Snapshot of the counters of one ChunkPool.
+     */
+    struct ChunkStats {
+        std::size_t chunk_bytes = 0; // size of one chunk
+        uint64_t chunks = 0; // chunks owned right now
+        uint64_t chunks_created = 0;
+        uint64_t chunks_freed = 0;
+        uint64_t peak_chunks = 0;
+        uint64_t bytes_reserved = 0; // chunks * chunk_bytes
+        uint64_t bytes_committed = 0; // part of bytes_reserved backed by memory
+        uint64_t bytes_in_use = 0; // blocks handed out, rounded up to their size class
+        uint64_t peak_bytes_in_use = 0;
+        uint64_t tail_bytes = 0; // never carved free tails of all chunks
+        uint64_t padding_bytes = 0; // skipped to align blocks, over the whole lifetime
+        uint64_t failed_probes = 0; // chunks checked by can_allocate that could not fit a request
+        uint64_t reused_blocks = 0; // allocations served by returned blocks
+        uint64_t large_blocks = 0; // live blocks too big for a chunk
+        uint64_t large_bytes = 0; // memory held by them, headers included
+        std::vector<uint64_t> allocations_by_class; // [k] counts blocks of min(2^k, chunk_bytes) bytes
+
+        /// Average free tail of a chunk.
+        double tail_bytes_per_chunk() const {
+            return (chunks == 0) ? 0.0 : double(tail_bytes) / double(chunks);
+        }
+
+        /**
+         * Adds the counters of another pool with the same chunk size.
+         * Peaks become the sum of the peaks of both pools, an upper bound of the common peak.
+         */
+        ChunkStats &operator+=(const ChunkStats &other) {
+            chunks += other.chunks;
+            chunks_created += other.chunks_created;
+            chunks_freed += other.chunks_freed;
+            peak_chunks += other.peak_chunks;
+            bytes_reserved += other.bytes_reserved;
+            bytes_committed += other.bytes_committed;
+            bytes_in_use += other.bytes_in_use;
+            peak_bytes_in_use += other.peak_bytes_in_use;
+            tail_bytes += other.tail_bytes;
+            padding_bytes += other.padding_bytes;
+            failed_probes += other.failed_probes;
+            reused_blocks += other.reused_blocks;
+            large_blocks += other.large_blocks;
+            large_bytes += other.large_bytes;
+            if (allocations_by_class.size() < other.allocations_by_class.size()) {
+                allocations_by_class.resize(other.allocations_by_class.size());
+            }
+            for (std::size_t k = 0; k < other.allocations_by_class.size(); ++k) {
+                allocations_by_class[k] += other.allocations_by_class[k];
+            }
+            return *this;
+        }
+
+        /// Single JSON object with all the fields.
+        std::string to_json() const {
+            std::ostringstream os;
+            os << "{\"chunk_bytes\":" << chunk_bytes
+               << ",\"chunks\":" << chunks
+               << ",\"chunks_created\":" << chunks_created
+               << ",\"chunks_freed\":" << chunks_freed
+               << ",\"peak_chunks\":" << peak_chunks
+               << ",\"bytes_reserved\":" << bytes_reserved
+               << ",\"bytes_committed\":" << bytes_committed
+               << ",\"bytes_in_use\":" << bytes_in_use
+               << ",\"peak_bytes_in_use\":" << peak_bytes_in_use
+               << ",\"tail_bytes\":" << tail_bytes
+               << ",\"tail_bytes_per_chunk\":" << tail_bytes_per_chunk()
+               << ",\"padding_bytes\":" << padding_bytes
+               << ",\"failed_probes\":" << failed_probes
+               << ",\"reused_blocks\":" << reused_blocks
+               << ",\"large_blocks\":" << large_blocks
+               << ",\"large_bytes\":" << large_bytes
+               << ",\"allocations_by_class\":{";
+            bool first = true;
+            for (std::size_t k = 0; k < allocations_by_class.size(); ++k) {
+                if (allocations_by_class[k] == 0) {
+                    continue;
+                }
+                std::size_t block = (std::size_t(1) << k < chunk_bytes) ? std::size_t(1) << k : chunk_bytes;
+                os << (first ? "" : ",") << '"' << block << "\":" << allocations_by_class[k];
+                first = false;
+            }
+            os << "}}";
+            return os.str();
+        }
+    };
+
+
+    /**
+     * Live counters of one ChunkPool.
+     * Only the thread that owns the pool (or holds its lock) writes them, so an update is
+     * a relaxed load and store without a locked instruction. Any thread may read them.
+     */
+    template<std::size_t Classes>
+    struct ChunkCounters {
+        std::atomic<uint64_t> chunks_created{0};
+        std::atomic<uint64_t> chunks_freed{0};
+        std::atomic<uint64_t> peak_chunks{0};
+        std::atomic<uint64_t> bytes_committed{0};
+        std::atomic<uint64_t> bytes_in_use{0};
+        std::atomic<uint64_t> peak_bytes_in_use{0};
+        std::atomic<uint64_t> tail_bytes{0};
+        std::atomic<uint64_t> padding_bytes{0};
+        std::atomic<uint64_t> failed_probes{0};
+        std::atomic<uint64_t> reused_blocks{0};
+        std::atomic<uint64_t> large_blocks{0};
+        std::atomic<uint64_t> large_bytes{0};
+        std::atomic<uint64_t> allocations[Classes] = {};
+
+        static void add(std::atomic<uint64_t> &counter, uint64_t value) {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        static void sub(std::atomic<uint64_t> &counter, uint64_t value) {
+            counter.store(counter.load(std::memory_order_relaxed) - value, std::memory_order_relaxed);
+        }
+
+        static void raise(std::atomic<uint64_t> &peak, uint64_t value) {
+            if (value > peak.load(std::memory_order_relaxed)) {
+                peak.store(value, std::memory_order_relaxed);
+            }
+        }
+
+        ChunkStats snapshot(std::size_t chunk_bytes) const {
+            ChunkStats stats;
+            stats.chunk_bytes = chunk_bytes;
+            stats.chunks_created = chunks_created.load(std::memory_order_relaxed);
+            stats.chunks_freed = chunks_freed.load(std::memory_order_relaxed);
+            stats.chunks = stats.chunks_created - stats.chunks_freed;
+            stats.peak_chunks = peak_chunks.load(std::memory_order_relaxed);
+            stats.bytes_reserved = stats.chunks * chunk_bytes;
+            stats.bytes_committed = bytes_committed.load(std::memory_order_relaxed);
+            stats.bytes_in_use = bytes_in_use.load(std::memory_order_relaxed);
+            stats.peak_bytes_in_use = peak_bytes_in_use.load(std::memory_order_relaxed);
+            stats.tail_bytes = tail_bytes.load(std::memory_order_relaxed);
+            stats.padding_bytes = padding_bytes.load(std::memory_order_relaxed);
+            stats.failed_probes = failed_probes.load(std::memory_order_relaxed);
+            stats.reused_blocks = reused_blocks.load(std::memory_order_relaxed);
+            stats.large_blocks = large_blocks.load(std::memory_order_relaxed);
+            stats.large_bytes = large_bytes.load(std::memory_order_relaxed);
+            for (const auto &counter: allocations) {
+                stats.allocations_by_class.push_back(counter.load(std::memory_order_relaxed));
+            }
+            return stats;
+        }
+    };
+
+} // namespace task
+
+
+#endif //HW_5_ALLOCATOR_CHUNK_STATS_H
@@ -0,0 +1,143 @@
+#ifndef HW_5_ALLOCATOR_CHUNK_TRACE_H
+#define HW_5_ALLOCATOR_CHUNK_TRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+
+namespace task {
+
+    /**
+     * Events reported by ChunkAllocator to its tracer.
+     */
+    enum class TraceEvent : uint8_t {
+        ALLOCATOR_CREATED,
+        ALLOCATOR_COPIED,
+        ALLOCATOR_DESTROYED,
+        ALLOCATE,
+        DEALLOCATE,
+        CONSTRUCT,
+        DESTROY,
+        BAD_ALLOC,
+        CHUNK_CREATED,
+        CHUNK_FREED,
+        ROLLBACK,
+        RESET,
+    };
+
+    inline const char *trace_event_name(TraceEvent event) {
+        switch (event) {
+            case TraceEvent::ALLOCATOR_CREATED:
+                return "allocator created";
+            case TraceEvent::ALLOCATOR_COPIED:
+                return "allocator copied";
+            case TraceEvent::ALLOCATOR_DESTROYED:
+                return "allocator destroyed";
+            case TraceEvent::ALLOCATE:
+                return "allocate";
+            case TraceEvent::DEALLOCATE:
+                return "deallocate";
+            case TraceEvent::CONSTRUCT:
+                return "construct";
+            case TraceEvent::DESTROY:
+                return "destroy";
+            case TraceEvent::BAD_ALLOC:
+                return "bad_alloc";
+            case TraceEvent::CHUNK_CREATED:
+                return "chunk created";
+            case TraceEvent::CHUNK_FREED:
+                return "chunk freed";
+            case TraceEvent::ROLLBACK:
+                return "rollback";
+            case TraceEvent::RESET:
+                return "reset";
+        }
+        return "unknown";
+    }
+
+
+    /**
+     * Tracer that records nothing. Every call is empty and inlined away.
+     */
+    struct NoTrace {
+        static void record(TraceEvent, const void *, std::size_t = 0) noexcept {}
+    };
+
+
+    /**
+     * Tracer keeping the last Capacity events in a lock-free ring buffer.
+     * A writer claims a slot with one fetch_add and publishes it by its sequence number,
+     * so recording never blocks and never does I/O. dump() prints the events afterwards.
+     */
+    template<std::size_t Capacity = 4096>
+    class RingTrace {
+    private:
+        struct Record {
+            std::atomic<uint64_t> sequence{0}; // 1 + number of the event, 0 while it is written
+            std::atomic<TraceEvent> event{};
+            std::atomic<const void *> address{nullptr};
+            std::atomic<std::size_t> bytes{0};
+        };
+
+        static inline Record records[Capacity];
+        static inline std::atomic<uint64_t> head{0}; // number of events recorded so far
+
+    public:
+        static void record(TraceEvent event, const void *address, std::size_t bytes = 0) noexcept {
+            uint64_t number = head.fetch_add(1, std::memory_order_relaxed);
+            Record &slot = records[number % Capacity];
+            slot.sequence.store(0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.event.store(event, std::memory_order_relaxed);
+            slot.address.store(address, std::memory_order_relaxed);
+            slot.bytes.store(bytes, std::memory_order_relaxed);
+            slot.sequence.store(number + 1, std::memory_order_release);
+        }
+
+        /// Number of events recorded so far, including overwritten ones.
+        static uint64_t size() noexcept {
+            return head.load(std::memory_order_acquire);
+        }
+
+        /**
+         * Prints the events still kept in the buffer, oldest first.
+         * Slots overwritten while dumping are skipped.
+         */
+        static void dump(std::ostream &os) {
+            uint64_t last = size();
+            uint64_t first = (last > Capacity) ? last - Capacity : 0;
+            for (uint64_t number = first; number < last; ++number) {
+                Record &slot = records[number % Capacity];
+                if (slot.sequence.load(std::memory_order_acquire) != number + 1) {
+                    continue;
+                }
+                TraceEvent event = slot.event.load(std::memory_order_relaxed);
+                const void *address = slot.address.load(std::memory_order_relaxed);
+                std::size_t bytes = slot.bytes.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) != number + 1) {
+                    continue;
+                }
+                os << '#' << number << ' ' << trace_event_name(event) << " at " << address;
+                if (bytes != 0) {
+                    os << " : " << bytes << " bytes";
+                }
+                os << '\n';
+            }
+        }
+
+        /// Forgets all events. Must not race with writers.
+        static void clear() noexcept {
+            for (auto &slot: records) {
+                slot.sequence.store(0, std::memory_order_relaxed);
+            }
+            head.store(0, std::memory_order_release);
+        }
+    };
+
+} // namespace task
+
+
+#endif //HW_5_ALLOCATOR_CHUNK_TRACE_H
@@ -0,0 +1,279 @@
+#ifndef HW_5_ALLOCATOR_POOL_ALLOCATOR_H
+#define HW_5_ALLOCATOR_POOL_ALLOCATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "chunk_allocator.h"
+
+
+namespace task {
+
+    /// Mutex that does nothing, for pools that are used from one thread.
+    struct NoMutex {
+        void lock() {}
+
+        void unlock() {}
+    };
+
+
+    /**
+     * Interface of SlotPool-s of every slot size kept in one PoolSet.
+     */
+    class SlotPoolBase {
+    public:
+        virtual ~SlotPoolBase() = default;
+    };
+
+
+    /**
+     * Slots of Slot bytes aligned to Align carved from chunks one after another.
+     * A freed slot is pushed onto an intrusive free list, the next pointer is
+     * stored inside the slot itself, so allocate and deallocate are O(1).
+     * Chunks are never freed before the pool is destroyed.
+     */
+    template<std::size_t Slot, std::size_t Align, typename Policy>
+    class SlotPool : public SlotPoolBase {
+        static_assert(Slot >= sizeof(void *) && Slot % Align == 0, "SlotPool: slot must fit a pointer and keep alignment");
+    public:
+        using chunk_type = Chunk<Policy::chunk_bytes,
+                (Align > alignof(std::max_align_t)) ? Align : alignof(std::max_align_t),
+                typename Policy::backing>;
+
+        static const std::size_t SLOTS = chunk_type::CAPACITY / Slot; // slots in every chunk
+        static_assert(SLOTS > 0, "SlotPool: slot does not fit a chunk");
+
+    private:
+        using mutex_type = typename std::conditional<Policy::thread_safe, std::mutex, NoMutex>::type;
+
+        ChunkList<chunk_type> chunks; // the last one has the free tail
+        void *free_head = nullptr; // returned slots
+        mutex_type mutex;
+
+    public:
+        SlotPool() = default;
+
+        SlotPool(const SlotPool &) = delete;
+
+        SlotPool &operator=(const SlotPool &) = delete;
+
+        /// Number of chunks owned by the pool.
+        std::size_t size() const {
+            return chunks.size;
+        }
+
+        void *allocate() {
+            std::lock_guard<mutex_type> lock(mutex);
+            if (free_head != nullptr) {
+                void *res = free_head;
+                std::memcpy(&free_head, res, sizeof(void *));
+                return res;
+            }
+            if (chunks.last == nullptr || !chunks.last->can_allocate(Slot)) {
+                chunks.add();
+                Policy::tracer::record(TraceEvent::CHUNK_CREATED, chunks.last->data(), chunk_type::CAPACITY);
+            }
+            return chunks.last->allocate(Slot);
+        }
+
+        void deallocate(void *slot) noexcept {
+            std::lock_guard<mutex_type> lock(mutex);
+            std::memcpy(slot, &free_head, sizeof(void *));
+            free_head = slot;
+        }
+    };
+
+
+    /**
+     * SlotPool-s shared by all copies of one PoolAllocator and of its rebound copies,
+     * one per slot size and alignment. A pool is made on the first use of its size.
+     */
+    template<typename Policy>
+    class PoolSet {
+    private:
+        using mutex_type = typename std::conditional<Policy::thread_safe, std::mutex, NoMutex>::type;
+
+        std::map<std::pair<std::size_t, std::size_t>, std::unique_ptr<SlotPoolBase>> pools;
+        mutex_type mutex; // guards pools
+
+    public:
+        std::atomic<long> users{1}; // number of allocators sharing the set
+
+        template<std::size_t Slot, std::size_t Align>
+        SlotPool<Slot, Align, Policy> *get() {
+            std::lock_guard<mutex_type> lock(mutex);
+            auto &pool = pools[std::make_pair(Slot, Align)];
+            if (pool == nullptr) {
+                pool.reset(new SlotPool<Slot, Align, Policy>());
+            }
+            return static_cast<SlotPool<Slot, Align, Policy> *>(pool.get());
+        }
+    };
+
+
+    /**
+     Allocator of single fixed-size objects, e.g. nodes of lists, trees and control blocks.
+     allocate(1) takes a slot of a SlotPool sized for T at compile time; arrays and
+     objects bigger than a chunk go to the aligned operator new.
+     */
+    template<typename T, typename Policy = DefaultChunkPolicy>
+    class PoolAllocator {
+    private:
+        template<typename U, typename P>
+        friend class PoolAllocator;
+
+        static const std::size_t ALIGNMENT = (Policy::alignment > alignof(T)) ? Policy::alignment : alignof(T);
+        static_assert((ALIGNMENT & (ALIGNMENT - 1)) == 0, "PoolAllocator: alignment must be a power of two");
+
+        static const std::size_t OBJECT = (sizeof(T) > sizeof(void *)) ? sizeof(T) : sizeof(void *);
+
+    public:
+        static const std::size_t SLOT = (OBJECT + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT; // bytes of every slot
+        static const bool POOLED = SLOT <= Policy::chunk_bytes; // allocate(1) is served by a SlotPool
+
+    private:
+        using slot_pool = typename std::conditional<POOLED,
+                SlotPool<SLOT, ALIGNMENT, Policy>, SlotPoolBase>::type; // stays nullptr unless POOLED
+
+        PoolSet<Policy> *set; // pools shared with all copies
+        slot_pool *slots; // the pool of this T inside set
+
+        slot_pool *find_slots() const {
+            if constexpr (POOLED) {
+                return set->template get<SLOT, ALIGNMENT>();
+            } else {
+                return nullptr;
+            }
+        }
+
+    public:
+        using value_type = T;
+        using pointer = T *;
+        using const_pointer = const T *;
+        using reference = T &;
+        using difference_type = std::ptrdiff_t; // signed
+        using const_reference = const T &;
+        using size_type = std::size_t;
+        template<class U>
+        struct rebind {
+            typedef PoolAllocator<U, Policy> other;
+        };
+
+        // Copies share one set of pools, so it follows the memory like ChunkAllocator does.
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+        using is_always_equal = std::false_type;
+
+        PoolAllocator() : set(new PoolSet<Policy>()), slots(find_slots()) {}
+
+        PoolAllocator(const PoolAllocator &other) : set(other.set), slots(other.slots) {
+            this->set->users.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /// Rebound copy: shares the set of pools and takes the pool of its own slot size.
+        template<typename U>
+        PoolAllocator(const PoolAllocator<U, Policy> &other) : set(other.set), slots(nullptr) {
+            this->set->users.fetch_add(1, std::memory_order_relaxed);
+            this->slots = find_slots();
+        }
+
+        PoolAllocator &operator=(const PoolAllocator &other) {
+            if (this->set != other.set) {
+                other.set->users.fetch_add(1, std::memory_order_relaxed);
+                release_set();
+                this->set = other.set;
+                this->slots = other.slots;
+            }
+            return *this;
+        }
+
+        size_t max_size() const {
+            return std::numeric_limits<size_type>::max() / sizeof(T);
+        }
+
+        /// Checks that other hands out memory from the same pools.
+        template<typename U>
+        bool same_pool(const PoolAllocator<U, Policy> &other) const noexcept {
+            return this->set == other.set;
+        }
+
+        /// Number of chunks holding slots of T.
+        std::size_t chunks() const {
+            if constexpr (POOLED) {
+                return slots->size();
+            } else {
+                return 0;
+            }
+        }
+
+        pointer allocate(size_type n) {
+            if constexpr (POOLED) {
+                if (n == 1) {
+                    return static_cast<T *>(slots->allocate());
+                }
+            }
+            if (n > max_size()) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(ALIGNMENT)));
+        }
+
+        void deallocate(pointer p, size_type n) noexcept {
+            if constexpr (POOLED) {
+                if (n == 1) {
+                    slots->deallocate(p);
+                    return;
+                }
+            }
+            ::operator delete(p, std::align_val_t(ALIGNMENT));
+        }
+
+        template<typename U, typename ... Args>
+        void construct(U *p, Args &&... args) {
+            new(p) U(std::forward<Args>(args)...);
+        }
+
+        template<typename U>
+        void destroy(U *p) {
+            p->~U();
+        }
+
+        ~PoolAllocator() {
+            release_set();
+        }
+
+    private:
+        /// Drops this user of the set, the last one deletes it with all chunks.
+        void release_set() {
+            if (this->set->users.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                delete this->set;
+            }
+        }
+    }; // PoolAllocator<>
+
+
+    /// Allocators are equal when they share the pools, so one can free what the other allocated.
+    template<typename T, typename U, typename Policy>
+    bool operator==(const PoolAllocator<T, Policy> &a, const PoolAllocator<U, Policy> &b) noexcept {
+        return a.same_pool(b);
+    }
+
+    template<typename T, typename U, typename Policy>
+    bool operator!=(const PoolAllocator<T, Policy> &a, const PoolAllocator<U, Policy> &b) noexcept {
+        return !(a == b);
+    }
+
+} // namespace task
+
+
+#endif //HW_5_ALLOCATOR_POOL_ALLOCATOR_H
@@ -0,0 +1,14 @@
+#!/bin/bash
+
+set -e
+
+g++ -std=c++17 -O2 -I./ bench/sort.cpp -o list_sort_bench -pthread
+g++ -std=c++17 -O2 -I./ bench/scan.cpp -o list_scan_bench
+g++ -std=c++17 -O2 -I./ bench/queue.cpp -o list_queue_bench
+g++ -std=c++17 -O2 -I./ bench/concurrent.cpp -o list_concurrent_bench -pthread
+g++ -std=c++17 -O2 -I./ bench/locality.cpp -o list_locality_bench -pthread
+./list_sort_bench "$@"
+./list_scan_bench "$@"
+./list_queue_bench "$@"
+./list_concurrent_bench "$@"
+./list_locality_bench "$@"
@@ -0,0 +1,91 @@
+#include "src/concurrent_list.h"
+#include "src/list.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+using Clock = std::chrono::steady_clock;
+
+/// task::list behind one mutex, what concurrent_list replaces.
+class LockedList {
+private:
+    std::mutex mutex;
+    task::list<uint64_t> list;
+
+public:
+    void push_back(uint64_t value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        list.push_back(value);
+    }
+
+    bool try_pop_front(uint64_t &value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (list.empty()) {
+            return false;
+        }
+        value = list.front();
+        list.pop_front();
+        return true;
+    }
+};
+
+/**
+ * One producer pushes n elements at the back, consumers pop them from the front.
+ * Returns millions of elements per second passed through the queue.
+ */
+template<class Queue>
+double throughput(std::size_t n, int consumers) {
+    Queue queue;
+    std::atomic<std::size_t> popped{0};
+    std::atomic<uint64_t> sum{0};
+    auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < consumers; ++i) {
+        threads.emplace_back([&]() {
+            uint64_t local = 0;
+            uint64_t value;
+            while (popped.load(std::memory_order_relaxed) < n) {
+                if (queue.try_pop_front(value)) {
+                    local += value;
+                    popped.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            sum.fetch_add(local, std::memory_order_relaxed);
+        });
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        queue.push_back(i);
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (sum.load() != uint64_t(n) * (n - 1) / 2) {
+        std::printf("lost elements\n");
+        std::exit(1);
+    }
+    return double(n) / seconds / 1e6;
+}
+
+
+int main(int argc, char **argv) {
+    std::size_t n = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+    std::printf("1 producer, %zu elements, %u hardware threads, millions of elements per second\n", n,
+                std::thread::hardware_concurrency());
+    std::printf("%10s %16s %16s\n", "consumers", "mutex + list", "concurrent_list");
+    for (int consumers = 1; consumers <= 8; consumers *= 2) {
+        std::printf("%10d %16.2f %16.2f\n", consumers, throughput<LockedList>(n, consumers),
+                    throughput<task::concurrent_list<uint64_t>>(n, consumers));
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include "src/list.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+
+using Clock = std::chrono::steady_clock;
+
+/// Nanoseconds per element of summing the list rounds times.
+double time_scan(const task::list<uint64_t> &list, int rounds) {
+    volatile uint64_t sink = 0;
+    auto start = Clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        uint64_t sum = 0;
+        for (auto it = list.cbegin(); it != list.cend(); ++it) {
+            sum += *it;
+        }
+        sink = sink + sum;
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / double(list.size()) / rounds;
+}
+
+void report(const char *state, const task::list<uint64_t> &list, int rounds) {
+    task::list_footprint footprint = list.footprint();
+    std::printf("%-12s %14.0f %14zu %12.2f\n", state, footprint.mean_distance, footprint.cache_lines,
+                time_scan(list, rounds));
+}
+
+
+int main(int argc, char **argv) {
+    std::size_t n = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    int rounds = (argc > 2) ? std::atoi(argv[2]) : 10;
+
+    task::list<uint64_t> list;
+    for (std::size_t i = 0; i < n; ++i) {
+        list.push_back(i);
+    }
+    task::list_footprint footprint = list.footprint();
+    std::printf("%zu uint64_t: %zu node bytes, %zu payload bytes, %zu object bytes, %zu allocator bytes\n", n,
+                footprint.node_bytes, footprint.payload_bytes, footprint.object_bytes, footprint.allocator_bytes);
+    std::printf("%-12s %14s %14s %12s\n", "list", "mean distance", "cache lines", "scan ns/el");
+    report("fresh", list, rounds);
+
+    // Churn: move every node to the end in random order, the traversal order no longer follows addresses.
+    std::vector<task::list<uint64_t>::iterator> nodes;
+    nodes.reserve(n);
+    for (auto it = list.begin(); it != list.end(); ++it) {
+        nodes.push_back(it);
+    }
+    std::shuffle(nodes.begin(), nodes.end(), std::mt19937_64(7));
+    for (auto it: nodes) {
+        list.splice(list.end(), list, it);
+    }
+    report("churned", list, rounds);
+
+    auto start = Clock::now();
+    list.relocate_compact();
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / double(n);
+    report("compacted", list, rounds);
+    std::printf("relocate_compact: %.2f ns per element\n", ns);
+    return 0;
+}
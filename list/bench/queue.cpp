@@ -0,0 +1,48 @@
+#include "src/list.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * Nanoseconds per push_back/pop_front pair of a queue kept at depth elements.
+ */
+template<class List>
+double time_queue(std::size_t depth, std::size_t n) {
+    List queue;
+    for (std::size_t i = 0; i < depth; ++i) {
+        queue.push_back(i);
+    }
+    volatile uint64_t sink = 0;
+    auto start = Clock::now();
+    for (std::size_t i = 0; i < n; ++i) {
+        queue.push_back(i);
+        sink = sink + queue.front();
+        queue.pop_front();
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / double(n);
+}
+
+template<std::size_t Depth>
+void compare(std::size_t n) {
+    using cached = task::list<uint64_t, std::allocator<uint64_t>, task::node_cache<64>>;
+    std::printf("%10zu %12.2f %12.2f %12.2f\n", Depth, time_queue<std::list<uint64_t>>(Depth, n),
+                time_queue<task::list<uint64_t>>(Depth, n), time_queue<cached>(Depth, n));
+}
+
+
+int main(int argc, char **argv) {
+    std::size_t n = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+    std::printf("queue, ns per push_back + pop_front\n");
+    std::printf("%10s %12s %12s %12s\n", "depth", "std::list", "task::list", "node_cache");
+    compare<1>(n);
+    compare<64>(n);
+    compare<4096>(n);
+    return 0;
+}
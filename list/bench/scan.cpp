@@ -0,0 +1,122 @@
+#include "src/list.h"
+#include "src/unrolled_list.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+using Clock = std::chrono::steady_clock;
+
+/// Nanoseconds per element of every phase of one run.
+struct Timings {
+    double build = -1;
+    double scan = -1;
+    double insert = -1; // -1 for containers where middle inserts are not O(1)
+    double scan_after = -1;
+};
+
+template<class Container>
+double ns_per_element(Clock::time_point start, const Container &container) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / double(container.size());
+}
+
+/// Sums the container rounds times; the result goes to a volatile so the loop is kept.
+template<class Container>
+double time_scan(const Container &container, int rounds) {
+    volatile uint64_t sink = 0;
+    auto start = Clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        uint64_t sum = 0;
+        for (auto value: container) {
+            sum += value;
+        }
+        sink = sink + sum;
+    }
+    return ns_per_element(start, container) / rounds;
+}
+
+/**
+ * push_back n elements, scan them, insert one element before every fourth one in
+ * a single pass and scan again. The inserted nodes of node-based lists land far
+ * from their neighbours, which is what the second scan shows.
+ */
+template<class Container>
+Timings run(std::size_t n, int rounds) {
+    Timings res;
+    Container container;
+    auto start = Clock::now();
+    for (std::size_t i = 0; i < n; ++i) {
+        container.push_back(i);
+    }
+    res.build = ns_per_element(start, container);
+    res.scan = time_scan(container, rounds);
+    if constexpr (!std::is_same<Container, std::vector<uint64_t>>::value) {
+        start = Clock::now();
+        std::size_t i = 0;
+        for (auto it = container.begin(); it != container.end(); ++it, ++i) {
+            if (i % 4 == 0) {
+                it = std::next(container.insert(it, i));
+            }
+        }
+        res.insert = ns_per_element(start, container);
+        res.scan_after = time_scan(container, rounds);
+    }
+    return res;
+}
+
+/// Runs one container in a forked child so that none of them reuses memory freed by another.
+template<class Container>
+Timings run_alone(std::size_t n, int rounds) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return Timings{};
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        Timings timings = run<Container>(n, rounds);
+        ssize_t written = write(fds[1], &timings, sizeof(timings));
+        _exit(written == sizeof(timings) ? 0 : 1);
+    }
+    close(fds[1]);
+    Timings timings;
+    if (pid < 0 || read(fds[0], &timings, sizeof(timings)) != sizeof(timings)) {
+        timings = Timings{};
+    }
+    close(fds[0]);
+    if (pid > 0) {
+        waitpid(pid, nullptr, 0);
+    }
+    return timings;
+}
+
+void report(const char *name, const Timings &timings) {
+    std::printf("%-22s %10.2f %10.2f", name, timings.build, timings.scan);
+    if (timings.insert < 0) {
+        std::printf(" %10s %10s\n", "-", "-");
+    } else {
+        std::printf(" %10.2f %10.2f\n", timings.insert, timings.scan_after);
+    }
+}
+
+
+int main(int argc, char **argv) {
+    std::size_t n = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    int rounds = (argc > 2) ? std::atoi(argv[2]) : 10;
+
+    std::printf("%zu uint64_t, ns per element\n", n);
+    std::printf("%-22s %10s %10s %10s %10s\n", "container", "build", "scan", "insert", "scan after");
+    report("std::vector", run_alone<std::vector<uint64_t>>(n, rounds));
+    report("std::list", run_alone<std::list<uint64_t>>(n, rounds));
+    report("task::list", run_alone<task::list<uint64_t>>(n, rounds));
+    report("task::unrolled_list", run_alone<task::unrolled_list<uint64_t>>(n, rounds));
+    report("unrolled_list 256 B", run_alone<task::unrolled_list<uint64_t, std::allocator<uint64_t>, 256>>(n, rounds));
+    return 0;
+}
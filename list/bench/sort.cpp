@@ -0,0 +1,112 @@
+#include "src/list.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <random>
+#include <thread>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * Record that can be neither copied nor moved, so only relinking can sort it.
+ */
+struct Record {
+    uint64_t key;
+    char payload[24];
+
+    explicit Record(uint64_t key) : key(key), payload() {}
+
+    Record(const Record &) = delete;
+
+    Record &operator=(const Record &) = delete;
+
+    bool operator<(const Record &other) const {
+        return key < other.key;
+    }
+};
+
+/// Seconds taken by sorting a list of n elements with keys from make_key, with task::par if Parallel.
+template<class List, bool Parallel, class MakeKey>
+double time_sort(std::size_t n, MakeKey make_key) {
+    List list;
+    std::mt19937_64 rand(7);
+    for (std::size_t i = 0; i < n; ++i) {
+        list.emplace_back(make_key(rand, i));
+    }
+    auto start = Clock::now();
+    if constexpr (Parallel) {
+        list.sort(task::par);
+    } else {
+        list.sort();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    for (auto it = list.begin(), next = std::next(it); next != list.end(); ++it, ++next) {
+        if (*next < *it) {
+            std::printf("not sorted\n");
+            std::exit(1);
+        }
+    }
+    return seconds;
+}
+
+/**
+ * Runs time_sort in a forked child: nodes freed by an earlier run would otherwise come
+ * back from malloc in scattered order and slow down whichever list is measured second.
+ */
+template<class List, bool Parallel, class MakeKey>
+double time_sort_alone(std::size_t n, MakeKey make_key) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return -1;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        double seconds = time_sort<List, Parallel>(n, make_key);
+        ssize_t written = write(fds[1], &seconds, sizeof(seconds));
+        _exit(written == sizeof(seconds) ? 0 : 1);
+    }
+    close(fds[1]);
+    double seconds = -1;
+    if (pid < 0 || read(fds[0], &seconds, sizeof(seconds)) != sizeof(seconds)) {
+        seconds = -1;
+    }
+    close(fds[0]);
+    if (pid > 0) {
+        waitpid(pid, nullptr, 0);
+    }
+    return seconds;
+}
+
+template<class T, class MakeKey>
+void compare(const char *name, std::size_t n, MakeKey make_key) {
+    double std_seconds = time_sort_alone<std::list<T>, false>(n, make_key);
+    double task_seconds = time_sort_alone<task::list<T>, false>(n, make_key);
+    double par_seconds = time_sort_alone<task::list<T>, true>(n, make_key);
+    std::printf("%-16s %12zu %12.3f %12.3f %8.2fx %12.3f %8.2fx\n", name, n, std_seconds, task_seconds,
+                std_seconds / task_seconds, par_seconds, std_seconds / par_seconds);
+}
+
+
+int main(int argc, char **argv) {
+    std::size_t n = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    auto random_key = [](std::mt19937_64 &rand, std::size_t) { return rand(); };
+    auto sorted_key = [](std::mt19937_64 &, std::size_t i) { return static_cast<uint64_t>(i); };
+    auto few_keys = [](std::mt19937_64 &rand, std::size_t) { return rand() % 16; };
+
+    std::printf("%u hardware threads\n", std::thread::hardware_concurrency());
+    std::printf("%-16s %12s %12s %12s %9s %12s %9s\n", "sort", "elements", "std::list s", "task::list s", "speedup",
+                "par s", "speedup");
+    compare<uint64_t>("random ints", n, random_key);
+    compare<uint64_t>("sorted ints", n, sorted_key);
+    compare<uint64_t>("16 keys", n, few_keys);
+    compare<Record>("random records", n, random_key);
+    return 0;
+}
@@ -2,7 +2,7 @@
 
 set -e
 
-g++ -std=c++17 -I./ test/test.cpp -o list_test
+g++ -std=c++17 -I./ test/test.cpp -o list_test -pthread
 ./list_test
 
 echo All tests passed!
\ No newline at end of file
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+
+
+namespace task {
+
+
+    /**
+     * Concurrent sibling of task::list for producer and consumer threads: push_back, push_front
+     * and pop_front may be called from any number of threads at once.
+     *
+     * It is the two-lock queue of Michael and Scott. The head always points to a dummy node
+     * whose next is the first element. Pushing at the back takes only the tail lock, pushing at
+     * the front and popping take only the head lock, so producers and consumers do not wait for
+     * each other. A node is freed by pop_front after it became unreachable under the head lock,
+     * so no hazard pointers or epochs are needed.
+     *
+     * The allocator is called from many threads and has to be thread safe, like std::allocator is.
+     */
+    template<class T, class Alloc = std::allocator<T>>
+    class concurrent_list {
+    public:
+        concurrent_list();
+
+        explicit concurrent_list(const Alloc &alloc);
+
+        ~concurrent_list();
+
+        concurrent_list(const concurrent_list &) = delete;
+
+        concurrent_list &operator=(const concurrent_list &) = delete;
+
+        Alloc get_allocator() const;
+
+
+        /// Checks if the list had no elements at some moment during the call.
+        bool empty() const;
+
+        void push_back(const T &value);
+
+        void push_back(T &&value);
+
+        void push_front(const T &value);
+
+        void push_front(T &&value);
+
+        template<class... Args>
+        void emplace_back(Args &&... args);
+
+        template<class... Args>
+        void emplace_front(Args &&... args);
+
+        bool try_pop_front(T &value);
+
+        /**
+         * Member types
+         */
+    private:
+        typedef std::allocator_traits<Alloc> _traits;
+    public:
+        typedef T value_type;
+        typedef Alloc allocator_type;
+        typedef typename _traits::size_type size_type;
+
+        static_assert(
+                std::is_same<typename Alloc::value_type, value_type>::value,
+                "Allocator::value_type must be same type as value_type"
+        );
+
+    private:
+        /**
+         * Node with storage for one element. The dummy node has no element in its storage.
+         * next is written by pushers at the back and read by poppers at the front, under different locks.
+         */
+        struct Node {
+            std::atomic<Node *> next{nullptr};
+            alignas(T) unsigned char storage[sizeof(T)];
+
+            T *value() {
+                return std::launder(reinterpret_cast<T *>(storage));
+            }
+        };
+
+        typedef typename _traits::template rebind_alloc<Node> _node_allocator_type;
+        typedef typename _traits::template rebind_traits<Node> _node_traits;
+
+        static const std::size_t _CACHE_LINE = 64;
+
+        // Front and back live on their own cache lines, so producers and consumers do not share one.
+        alignas(_CACHE_LINE) mutable std::mutex _head_mutex;
+        Node *_head; // the dummy node
+        alignas(_CACHE_LINE) mutable std::mutex _tail_mutex;
+        Node *_tail;
+        alignas(_CACHE_LINE) _node_allocator_type _allocator;
+
+
+        /// Allocates a node without element, its next is nullptr.
+        Node *_allocate_node() {
+            Node *node = _node_traits::allocate(_allocator, 1);
+            _node_traits::construct(_allocator, node);
+            return node;
+        }
+
+        void _deallocate_node(Node *node) {
+            _node_traits::destroy(_allocator, node);
+            _node_traits::deallocate(_allocator, node, 1);
+        }
+
+        /// Allocates a node and constructs its element from args.
+        template<class... Args>
+        Node *_create_node(Args &&... args) {
+            Node *node = _allocate_node();
+            try {
+                _node_traits::construct(_allocator, node->value(), std::forward<Args>(args)...);
+            } catch (...) {
+                _deallocate_node(node);
+                throw;
+            }
+            return node;
+        }
+    };
+
+    /**
+     * Default constructor. Constructs an empty container with a default-constructed allocator.
+     */
+    template<class T, class Alloc>
+    concurrent_list<T, Alloc>::concurrent_list() :
+            _allocator() {
+        _head = _tail = _allocate_node();
+    }
+
+    /**
+     * Constructs an empty container with the given allocator alloc.
+     */
+    template<class T, class Alloc>
+    concurrent_list<T, Alloc>::concurrent_list(const Alloc &alloc) :
+            _allocator(alloc) {
+        _head = _tail = _allocate_node();
+    }
+
+    /**
+     * Destructs the list. No other thread may use it any more.
+     */
+    template<class T, class Alloc>
+    concurrent_list<T, Alloc>::~concurrent_list() {
+        Node *node = _head->next.load(std::memory_order_relaxed);
+        _deallocate_node(_head);
+        while (node != nullptr) {
+            Node *next = node->next.load(std::memory_order_relaxed);
+            _node_traits::destroy(_allocator, node->value());
+            _deallocate_node(node);
+            node = next;
+        }
+    }
+
+    /**
+     * Returns the allocator associated with the container.
+     */
+    template<class T, class Alloc>
+    Alloc concurrent_list<T, Alloc>::get_allocator() const {
+        return Alloc(_allocator);
+    }
+
+    template<class T, class Alloc>
+    bool concurrent_list<T, Alloc>::empty() const {
+        std::lock_guard<std::mutex> lock(_head_mutex);
+        return _head->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+    /**
+     * Appends the given element value to the end of the container.
+     */
+    template<class T, class Alloc>
+    void concurrent_list<T, Alloc>::push_back(const T &value) {
+        emplace_back(value);
+    }
+
+    template<class T, class Alloc>
+    void concurrent_list<T, Alloc>::push_back(T &&value) {
+        emplace_back(std::move(value));
+    }
+
+    /**
+     * Prepends the given element value to the beginning of the container.
+     */
+    template<class T, class Alloc>
+    void concurrent_list<T, Alloc>::push_front(const T &value) {
+        emplace_front(value);
+    }
+
+    template<class T, class Alloc>
+    void concurrent_list<T, Alloc>::push_front(T &&value) {
+        emplace_front(std::move(value));
+    }
+
+    /**
+     * Appends a new element constructed from args to the end of the container.
+     * The node is made before the tail lock is taken, the lock only covers linking it.
+     */
+    template<class T, class Alloc>
+    template<class... Args>
+    void concurrent_list<T, Alloc>::emplace_back(Args &&... args) {
+        Node *node = _create_node(std::forward<Args>(args)...);
+        std::lock_guard<std::mutex> lock(_tail_mutex);
+        _tail->next.store(node, std::memory_order_release);
+        _tail = node;
+    }
+
+    /**
+     * Inserts a new element constructed from args to the beginning of the container.
+     * The element is constructed in the storage of the current dummy node and a new dummy node
+     * is put before it, so the tail, which may be that dummy node, stays valid.
+     */
+    template<class T, class Alloc>
+    template<class... Args>
+    void concurrent_list<T, Alloc>::emplace_front(Args &&... args) {
+        Node *dummy = _allocate_node();
+        std::unique_lock<std::mutex> lock(_head_mutex);
+        try {
+            _node_traits::construct(_allocator, _head->value(), std::forward<Args>(args)...);
+        } catch (...) {
+            lock.unlock();
+            _deallocate_node(dummy);
+            throw;
+        }
+        dummy->next.store(_head, std::memory_order_relaxed);
+        _head = dummy;
+    }
+
+    /**
+     * Moves the first element into value and removes it. Returns false if the list is empty.
+     * The first node becomes the dummy node, the old dummy node is freed after the lock is released.
+     */
+    template<class T, class Alloc>
+    bool concurrent_list<T, Alloc>::try_pop_front(T &value) {
+        Node *old;
+        {
+            std::lock_guard<std::mutex> lock(_head_mutex);
+            Node *first = _head->next.load(std::memory_order_acquire);
+            if (first == nullptr) {
+                return false;
+            }
+            value = std::move(*first->value());
+            _node_traits::destroy(_allocator, first->value());
+            old = _head;
+            _head = first;
+        }
+        _deallocate_node(old);
+        return true;
+    }
+
+}  // namespace task
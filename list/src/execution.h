@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace task {
+
+
+    /**
+     * Execution policy tag for the parallel algorithms of task containers, in the spirit of
+     * std::execution::par. Work is split into node ranges run on std::thread-s.
+     * As with the standard policies, an exception escaping an element access function calls std::terminate.
+     */
+    struct parallel_policy {
+        /// Number of threads to use, 0 for std::thread::hardware_concurrency().
+        unsigned threads = 0;
+
+        /// Ranges shorter than this are not split further, threads would cost more than they save.
+        std::size_t min_per_thread = std::size_t(1) << 14;
+
+        /// Number of parts to split count elements into, at least 1.
+        std::size_t parts(std::size_t count) const {
+            std::size_t res = (threads != 0) ? threads : std::thread::hardware_concurrency();
+            std::size_t most = count / (min_per_thread != 0 ? min_per_thread : 1);
+            if (res > most) {
+                res = most;
+            }
+            return (res > 0) ? res : 1;
+        }
+    };
+
+    inline constexpr parallel_policy par{};
+
+
+    /**
+     * Splits [first, last) of count elements into parts ranges of nearly equal length.
+     * Returns parts + 1 boundaries. Walks the range once.
+     */
+    template<class ForwardIt>
+    std::vector<ForwardIt> split_range(ForwardIt first, std::size_t count, std::size_t parts) {
+        std::vector<ForwardIt> res;
+        res.reserve(parts + 1);
+        res.push_back(first);
+        for (std::size_t i = 0; i < parts; ++i) {
+            std::size_t length = count / parts + (i < count % parts ? 1 : 0);
+            first = std::next(first, length);
+            res.push_back(first);
+        }
+        return res;
+    }
+
+    /**
+     * Calls job(i) for i in [0, count), every call but the last on a thread of its own,
+     * and waits for all of them.
+     */
+    template<class Job>
+    void run_parallel(std::size_t count, Job job) {
+        std::vector<std::thread> threads;
+        threads.reserve(count);
+        for (std::size_t i = 0; i + 1 < count; ++i) {
+            threads.emplace_back(job, i);
+        }
+        if (count > 0) {
+            job(count - 1);
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+    }
+
+    /**
+     * Applies f to every element of [first, last), the range is split into node ranges
+     * processed by different threads. f must be safe to call concurrently on different elements.
+     */
+    template<class ForwardIt, class UnaryFunction>
+    void parallel_for_each(const parallel_policy &policy, ForwardIt first, ForwardIt last, UnaryFunction f) {
+        std::size_t count = std::distance(first, last);
+        std::size_t parts = policy.parts(count);
+        auto bounds = split_range(first, count, parts);
+        run_parallel(parts, [&bounds, f](std::size_t part) mutable {
+            for (auto it = bounds[part]; it != bounds[part + 1]; ++it) {
+                f(*it);
+            }
+        });
+    }
+
+    /**
+     * Applies transform to every element of [first, last) and reduces the results with reduce, starting
+     * from init. Every thread reduces one node range, the partial results are then combined in order,
+     * so reduce has to be associative but need not be commutative.
+     */
+    template<class ForwardIt, class T, class BinaryOp, class UnaryOp>
+    T parallel_transform_reduce(const parallel_policy &policy, ForwardIt first, ForwardIt last, T init,
+                                BinaryOp reduce, UnaryOp transform) {
+        std::size_t count = std::distance(first, last);
+        std::size_t parts = policy.parts(count);
+        auto bounds = split_range(first, count, parts);
+        std::vector<std::optional<T>> partial(parts);
+        run_parallel(parts, [&bounds, &partial, reduce, transform](std::size_t part) mutable {
+            auto it = bounds[part];
+            if (it == bounds[part + 1]) {
+                return;
+            }
+            T acc = transform(*it);
+            for (++it; it != bounds[part + 1]; ++it) {
+                acc = reduce(std::move(acc), transform(*it));
+            }
+            partial[part] = std::move(acc);
+        });
+        for (auto &value: partial) {
+            if (value) {
+                init = reduce(std::move(init), std::move(*value));
+            }
+        }
+        return init;
+    }
+
+    /**
+     * Reduces [first, last) with op, starting from init, like std::reduce: op has to be associative.
+     */
+    template<class ForwardIt, class T, class BinaryOp>
+    T parallel_reduce(const parallel_policy &policy, ForwardIt first, ForwardIt last, T init, BinaryOp op) {
+        return parallel_transform_reduce(policy, first, last, std::move(init), op,
+                                         [](const auto &value) -> T { return value; });
+    }
+
+    template<class ForwardIt, class T>
+    T parallel_reduce(const parallel_policy &policy, ForwardIt first, ForwardIt last, T init) {
+        return parallel_reduce(policy, first, last, std::move(init), [](T a, const T &b) { return a + b; });
+    }
+
+}  // namespace task
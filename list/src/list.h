@@ -1,9 +1,19 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
 #include <limits>
 #include <iterator>
 #include <memory>
+#include <new>
 #include <iostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "execution.h"
 
 #define assert(expr, msg) \
     if (!expr) std::cerr << msg << std::endl;
@@ -12,10 +22,54 @@
 namespace task {
 
 
-    template<class T, class Alloc = std::allocator<T>>
+    /**
+     * Node recycling policy of task::list: up to Capacity freed nodes are kept by the list
+     * and reused by the next insertions, so a queue in a steady state does not call the allocator.
+     * node_cache<0> keeps none.
+     */
+    template<std::size_t Capacity>
+    struct node_cache {
+        static const std::size_t capacity = Capacity;
+    };
+
+    using no_node_cache = node_cache<0>;
+
+
+    /**
+     * Memory use and node locality of one list, made by list::footprint().
+     */
+    struct list_footprint {
+        std::size_t node_bytes = 0; // allocated nodes holding the elements, links and padding included
+        std::size_t payload_bytes = 0; // the elements themselves
+        std::size_t spare_bytes = 0; // spare nodes kept by the Cache policy
+        std::size_t object_bytes = 0; // the list object: sentinel, size, allocator and inline nodes
+        std::size_t allocator_bytes = 0; // the allocator stored in the object, 0 for a stateless one
+        double mean_distance = 0; // mean distance in bytes between the addresses of consecutive nodes
+        std::size_t cache_lines = 0; // estimate of cache lines touched by one traversal
+    };
+
+
+    /**
+     * Doubly-linked list. Cache is the node recycling policy.
+     * The first InlineNodes nodes, at most 64, live inside the list object itself, so a short list
+     * does not allocate. Such nodes cannot leave the object: when they are spliced, merged, swapped
+     * or moved into another list, their elements are moved into allocated nodes first, and iterators
+     * to those elements are invalidated. InlineNodes > 0 thus needs T to be move constructible.
+     */
+    template<class T, class Alloc = std::allocator<T>, class Cache = no_node_cache, std::size_t InlineNodes = 0>
     class list {
 
+    private:
+        struct NodeBase;
+        struct Node;
+
+        template<class InputIt>
+        using _RequireInputIter = typename std::enable_if<std::is_convertible<
+                typename std::iterator_traits<InputIt>::iterator_category, std::input_iterator_tag>::value>::type;
+
     public:
+        class const_iterator;
+
         class iterator {
         public:
             using difference_type = ptrdiff_t;
@@ -24,36 +78,120 @@ namespace task {
             using reference = T &;
             using iterator_category = std::bidirectional_iterator_tag;
 
-            iterator();
-
-            iterator(const iterator &);
+            iterator() = default;
 
-            iterator &operator=(const iterator &);
+            iterator(const iterator &) = default;
 
-            iterator &operator++();
+            iterator &operator=(const iterator &) = default;
 
-            iterator operator++(int);
+            iterator &operator++() {
+                _node = _node->next;
+                return *this;
+            }
 
-            reference operator*() const;
+            iterator operator++(int) {
+                iterator res = *this;
+                _node = _node->next;
+                return res;
+            }
 
-            pointer operator->() const;
+            reference operator*() const {
+                return *static_cast<Node *>(_node)->value();
+            }
 
-            iterator &operator--();
+            pointer operator->() const {
+                return static_cast<Node *>(_node)->value();
+            }
 
-            iterator operator--(int);
+            iterator &operator--() {
+                _node = _node->prev;
+                return *this;
+            }
 
-            bool operator==(iterator other) const;
+            iterator operator--(int) {
+                iterator res = *this;
+                _node = _node->prev;
+                return res;
+            }
 
-            bool operator!=(iterator other) const;
+            bool operator==(iterator other) const {
+                return _node == other._node;
+            }
 
-            // Your code goes here?..
+            bool operator!=(iterator other) const {
+                return _node != other._node;
+            }
 
         private:
-            // Your code hoes here...
+            friend class list;
+
+            friend class const_iterator;
+
+            NodeBase *_node = nullptr;
+
+            explicit iterator(NodeBase *node) : _node(node) {}
         };
 
         class const_iterator {
-            // Your code goes here...
+        public:
+            using difference_type = ptrdiff_t;
+            using value_type = T;
+            using pointer = const T *;
+            using reference = const T &;
+            using iterator_category = std::bidirectional_iterator_tag;
+
+            const_iterator() = default;
+
+            const_iterator(const const_iterator &) = default;
+
+            const_iterator(const iterator &other) : _node(other._node) {}
+
+            const_iterator &operator=(const const_iterator &) = default;
+
+            const_iterator &operator++() {
+                _node = _node->next;
+                return *this;
+            }
+
+            const_iterator operator++(int) {
+                const_iterator res = *this;
+                _node = _node->next;
+                return res;
+            }
+
+            reference operator*() const {
+                return *static_cast<Node *>(_node)->value();
+            }
+
+            pointer operator->() const {
+                return static_cast<Node *>(_node)->value();
+            }
+
+            const_iterator &operator--() {
+                _node = _node->prev;
+                return *this;
+            }
+
+            const_iterator operator--(int) {
+                const_iterator res = *this;
+                _node = _node->prev;
+                return res;
+            }
+
+            bool operator==(const_iterator other) const {
+                return _node == other._node;
+            }
+
+            bool operator!=(const_iterator other) const {
+                return _node != other._node;
+            }
+
+        private:
+            friend class list;
+
+            NodeBase *_node = nullptr; // not const: the list relinks nodes through const_iterator positions
+
+            explicit const_iterator(const NodeBase *node) : _node(const_cast<NodeBase *>(node)) {}
         };
 
         using reverse_iterator = std::reverse_iterator<iterator>;
@@ -68,6 +206,11 @@ namespace task {
 
         explicit list(size_t count, const Alloc &alloc = Alloc());
 
+        template<class InputIt, class = _RequireInputIter<InputIt>>
+        list(InputIt first, InputIt last, const Alloc &alloc = Alloc());
+
+        list(std::initializer_list<T> init, const Alloc &alloc = Alloc());
+
         ~list();
 
         list(const list &other);
@@ -78,6 +221,15 @@ namespace task {
 
         list &operator=(list &&other);
 
+        list &operator=(std::initializer_list<T> ilist);
+
+        void assign(size_t count, const T &value);
+
+        template<class InputIt, class = _RequireInputIter<InputIt>>
+        void assign(InputIt first, InputIt last);
+
+        void assign(std::initializer_list<T> ilist);
+
         Alloc get_allocator() const;
 
 
@@ -94,6 +246,10 @@ namespace task {
 
         iterator end();
 
+        const_iterator begin() const;
+
+        const_iterator end() const;
+
         const_iterator cbegin() const;
 
         const_iterator cend() const;
@@ -121,6 +277,11 @@ namespace task {
 
         iterator insert(const_iterator pos, size_t count, const T &value);
 
+        template<class InputIt, class = _RequireInputIter<InputIt>>
+        iterator insert(const_iterator pos, InputIt first, InputIt last);
+
+        iterator insert(const_iterator pos, std::initializer_list<T> ilist);
+
         iterator erase(const_iterator pos);
 
         iterator erase(const_iterator first, const_iterator last);
@@ -151,20 +312,45 @@ namespace task {
 
         void swap(list &other);
 
+        void shrink_to_fit();
+
+        list_footprint footprint(std::size_t cache_line = 64) const;
+
+        void relocate_compact();
+
 
         void merge(list &other);
 
+        template<class Compare>
+        void merge(list &other, Compare comp);
+
         void splice(const_iterator pos, list &other);
 
+        void splice(const_iterator pos, list &other, const_iterator it);
+
+        void splice(const_iterator pos, list &other, const_iterator first, const_iterator last);
+
         void remove(const T &value);
 
+        template<class UnaryPredicate>
+        void remove_if(UnaryPredicate p);
+
         void reverse();
 
         void unique();
 
+        template<class BinaryPredicate>
+        void unique(BinaryPredicate p);
+
         void sort();
 
-        // Your code goes here?..
+        template<class Compare>
+        void sort(Compare comp);
+
+        void sort(const parallel_policy &policy);
+
+        template<class Compare>
+        void sort(const parallel_policy &policy, Compare comp);
 
         /**
          * Member types
@@ -186,166 +372,664 @@ namespace task {
                 "Allocator::value_type must be same type as value_type"
         );
 
-        // typedef iterators
-
 
     private:
-        // Your code goes here...
+        /**
+         * Links of a node. The list keeps one inside itself as the sentinel:
+         * end() points to it, its next is the first node and its prev the last one.
+         */
+        struct NodeBase {
+            NodeBase *prev;
+            NodeBase *next;
+        };
 
-        class Node {
-        public:
-            Node *next = nullptr;
-//            Node *prev = nullptr;
-            pointer data = nullptr;
-            allocator_type _allocator;
+        /**
+         * Element node: links and the element itself in one allocation.
+         * The element is constructed in storage by the allocator, the node is never constructed as a whole.
+         */
+        struct Node : NodeBase {
+            alignas(T) unsigned char storage[sizeof(T)];
 
-            Node() = default;
+            T *value() {
+                return std::launder(reinterpret_cast<T *>(storage));
+            }
+        };
 
-            Node(allocator_type &allocator, const T &value) :
-                    _allocator(allocator) {
-                data = _traits::allocate(_allocator, 1);
-                _traits::construct(_allocator, data, value);
+        typedef typename _traits::template rebind_alloc<Node> _node_allocator_type;
+        typedef typename _traits::template rebind_traits<Node> _node_traits;
+
+        static_assert(InlineNodes <= 64, "list: at most 64 inline nodes");
+        static_assert(InlineNodes == 0 || std::is_move_constructible<T>::value,
+                      "list: inline nodes need a move constructible T");
+
+        /**
+         * N nodes inside the list object, used[i] tells whether nodes[i] is taken.
+         */
+        template<std::size_t N, class Dummy = void>
+        struct InlineSlots {
+            Node nodes[N];
+            std::uint64_t used = 0;
+
+            bool owns(const NodeBase *node) const {
+                return std::less_equal<const NodeBase *>()(nodes, node)
+                       && std::less<const NodeBase *>()(node, nodes + N);
+            }
+
+            /// A free inline node, or nullptr if all are taken.
+            Node *take() {
+                for (std::size_t i = 0; i < N; ++i) {
+                    if ((used & (std::uint64_t(1) << i)) == 0) {
+                        used |= std::uint64_t(1) << i;
+                        return &nodes[i];
+                    }
+                }
+                return nullptr;
+            }
+
+            void give_back(const NodeBase *node) {
+                used &= ~(std::uint64_t(1) << (static_cast<const Node *>(node) - nodes));
+            }
+
+            /// Number of taken nodes.
+            std::size_t in_use() const {
+                std::size_t res = 0;
+                for (std::uint64_t bits = used; bits != 0; bits &= bits - 1) {
+                    res += 1;
+                }
+                return res;
+            }
+        };
+
+        template<class Dummy>
+        struct InlineSlots<0, Dummy> {
+            static const std::uint64_t used = 0;
+
+            bool owns(const NodeBase *) const {
+                return false;
             }
 
-            Node(allocator_type &allocator, T &&value) :
-                    _allocator(allocator) {
-                data = _traits::allocate(_allocator, 1);
-                _traits::construct(_allocator, data, value);
+            Node *take() {
+                return nullptr;
             }
 
-            ~Node() {
-                _traits::destroy(_allocator, data);
-                _traits::deallocate(_allocator, data, 1);
+            void give_back(const NodeBase *) {}
+
+            std::size_t in_use() const {
+                return 0;
             }
         };
 
-        Node *_head = nullptr;
-        Node *_tail = nullptr;
+        /**
+         * Where nodes come from: the inline slots, the spare nodes made by the allocator, the allocator itself.
+         * The allocator is a base, not a member, so a stateless allocator takes no space in the list,
+         * and so are the slots, which take none when InlineNodes is 0. The spare nodes go with
+         * the allocator when it moves to another list, the slots always stay.
+         */
+        struct NodeSource : _node_allocator_type, InlineSlots<InlineNodes> {
+            NodeBase *spare = nullptr; // freed nodes kept by Cache, linked through next
+            std::size_t spare_count = 0;
+
+            NodeSource() = default;
+
+            explicit NodeSource(const _node_allocator_type &alloc) : _node_allocator_type(alloc) {}
+
+            explicit NodeSource(_node_allocator_type &&alloc) : _node_allocator_type(std::move(alloc)) {}
+        };
+
+        NodeBase _end{&_end, &_end};
         std::size_t _size = 0;
-        allocator_type _allocator;
-
-
-        void _erase(size_t index) {
-            if (_size > 0) {
-                if (index == 0) {
-                    if (_size == 1) {
-                        delete _head;
-                        _head = _tail = nullptr;
-                    } else {
-                        Node *tmp = _head;
-                        _head = _head->next;
-                        delete tmp;
-                    }
-                } else {
-                    Node *prev = _head;
-                    Node *cur = prev->next;
-                    std::size_t j(1);
-                    while (j < index) {
-                        prev = cur;
-                        cur = prev->next;
-                        j += 1;
+        NodeSource _nodes;
+
+
+        _node_allocator_type &_allocator() {
+            return _nodes;
+        }
+
+        const _node_allocator_type &_allocator() const {
+            return _nodes;
+        }
+
+        /// Checks that nodes of other can be freed by the allocator of *this.
+        bool _same_allocator(const list &other) const {
+            if constexpr (_node_traits::is_always_equal::value) {
+                return true;
+            } else {
+                return _allocator() == other._allocator();
+            }
+        }
+
+        /**
+         * Moves the element of an inline node into a node from _heap_node that takes its place in the list.
+         * Returns the new node.
+         */
+        NodeBase *_evict(NodeBase *node) {
+            Node *heap = _heap_node();
+            try {
+                _node_traits::construct(_allocator(), heap->value(), std::move(_value(node)));
+            } catch (...) {
+                _free_node(heap);
+                throw;
+            }
+            heap->prev = node->prev;
+            heap->next = node->next;
+            node->prev->next = heap;
+            node->next->prev = heap;
+            _destroy_node(node);
+            return heap;
+        }
+
+        /// Evicts all inline nodes, so that every node can be handed over to another list.
+        void _evict_inline() {
+            if constexpr (InlineNodes > 0) {
+                for (std::size_t i = 0; i < InlineNodes; ++i) {
+                    if (_nodes.used & (std::uint64_t(1) << i)) {
+                        _evict(&_nodes.nodes[i]);
                     }
-                    prev->next = cur->next;
-                    if (cur == _tail) {
-                        _tail = prev;
+                }
+            }
+        }
+
+        /**
+         * Evicts the inline nodes of [first, last). Returns the number of nodes in the range
+         * and sets first to the node now first in it.
+         */
+        std::size_t _evict_inline(NodeBase *&first, NodeBase *last) {
+            std::size_t count = 0;
+            NodeBase *before = first->prev;
+            for (NodeBase *node = first; node != last; node = node->next, ++count) {
+                if constexpr (InlineNodes > 0) {
+                    if (_nodes.owns(node)) {
+                        node = _evict(node);
                     }
-                    delete cur;
                 }
             }
-            _size -= 1;
+            first = before->next;
+            return count;
+        }
+
+        /// Evicts the inline nodes of other and returns its allocator, for taking over all nodes of other.
+        static _node_allocator_type &&_take_over(list &other) {
+            other._evict_inline();
+            return std::move(other._allocator());
+        }
+
+        /// Takes the spare nodes of other, *this must have none.
+        void _take_spares(list &other) {
+            _nodes.spare = other._nodes.spare;
+            _nodes.spare_count = other._nodes.spare_count;
+            other._nodes.spare = nullptr;
+            other._nodes.spare_count = 0;
+        }
+
+
+        /// Takes a spare node, or allocates one.
+        Node *_heap_node() {
+            if (Cache::capacity > 0 && _nodes.spare != nullptr) {
+                auto node = static_cast<Node *>(_nodes.spare);
+                _nodes.spare = _nodes.spare->next;
+                _nodes.spare_count -= 1;
+                return node;
+            }
+            return _node_traits::allocate(_allocator(), 1);
+        }
+
+        /// Takes a free inline node, a spare one or a new one, and constructs its element from args.
+        template<class... Args>
+        Node *_create_node(Args &&... args) {
+            Node *node = _nodes.take();
+            if (node == nullptr) {
+                node = _heap_node();
+            }
+            try {
+                _node_traits::construct(_allocator(), node->value(), std::forward<Args>(args)...);
+            } catch (...) {
+                _free_node(node);
+                throw;
+            }
+            return node;
+        }
+
+        /// Destroys the element of node and frees it, the node must be unlinked.
+        void _destroy_node(NodeBase *node) {
+            auto element_node = static_cast<Node *>(node);
+            _node_traits::destroy(_allocator(), element_node->value());
+            _free_node(element_node);
+        }
+
+        /// Returns an inline node to its slot, keeps other nodes without element as spares while Cache has room,
+        /// deallocates them otherwise.
+        void _free_node(Node *node) {
+            if (_nodes.owns(node)) {
+                _nodes.give_back(node);
+            } else if (_nodes.spare_count < Cache::capacity) {
+                node->next = _nodes.spare;
+                _nodes.spare = node;
+                _nodes.spare_count += 1;
+            } else {
+                _node_traits::deallocate(_allocator(), node, 1);
+            }
+        }
+
+        /// Links node right before pos.
+        static void _link_before(NodeBase *pos, NodeBase *node) {
+            node->next = pos;
+            node->prev = pos->prev;
+            pos->prev->next = node;
+            pos->prev = node;
+        }
+
+        /// Takes node out of its list, its own links are left as they are.
+        static void _unlink(NodeBase *node) {
+            node->prev->next = node->next;
+            node->next->prev = node->prev;
+        }
+
+        static T &_value(NodeBase *node) {
+            return *static_cast<Node *>(node)->value();
+        }
+
+        /// Moves [first, last) of some list right before pos, pos must not be inside the range.
+        static void _transfer(NodeBase *pos, NodeBase *first, NodeBase *last) {
+            if (first == last || pos == last) {
+                return;
+            }
+            NodeBase *tail = last->prev;
+            first->prev->next = last;
+            last->prev = first->prev;
+            first->prev = pos->prev;
+            tail->next = pos;
+            pos->prev->next = first;
+            pos->prev = tail;
+        }
+
+        /**
+         * Nodes first..last linked to each other but not to any sentinel, last->next is nullptr.
+         */
+        struct Chain {
+            NodeBase *first;
+            NodeBase *last;
+        };
+
+        /**
+         * Merges two sorted chains, a goes first among equal elements.
+         * Links are kept in both directions as nodes are visited, so no pass is needed afterwards.
+         */
+        template<class Compare>
+        static Chain _merge_chains(Chain a, Chain b, Compare &comp) {
+            NodeBase head{nullptr, nullptr};
+            NodeBase *tail = &head;
+            NodeBase *x = a.first;
+            NodeBase *y = b.first;
+            while (x != nullptr && y != nullptr) {
+                if (comp(_value(y), _value(x))) {
+                    tail->next = y;
+                    y->prev = tail;
+                    tail = y;
+                    y = y->next;
+                } else {
+                    tail->next = x;
+                    x->prev = tail;
+                    tail = x;
+                    x = x->next;
+                }
+            }
+            Chain res{head.next, (x != nullptr) ? a.last : (y != nullptr) ? b.last : tail};
+            tail->next = (x != nullptr) ? x : y;
+            if (tail->next != nullptr) {
+                tail->next->prev = tail;
+            }
+            return res;
         }
 
+        /**
+         * Stable bottom-up merge sort of a chain.
+         * bins[i] holds a sorted run of 2^i nodes, so 64 of them cover any chain
+         * and the extra memory is O(1).
+         */
+        template<class Compare>
+        static Chain _sort_chain(Chain chain, Compare &comp) {
+            Chain bins[64] = {};
+            std::size_t filled = 0;
+            NodeBase *node = chain.first;
+            while (node != nullptr) {
+                Chain run{node, node};
+                node = node->next;
+                run.last->next = nullptr;
+                std::size_t i = 0;
+                for (; i < filled && bins[i].first != nullptr; ++i) {
+                    run = _merge_chains(bins[i], run, comp); // bins[i] holds earlier nodes
+                    bins[i].first = nullptr;
+                }
+                if (i == filled) {
+                    filled += 1;
+                }
+                bins[i] = run;
+            }
+            Chain res{nullptr, nullptr};
+            for (std::size_t i = 0; i < filled; ++i) {
+                if (bins[i].first != nullptr) {
+                    res = (res.first == nullptr) ? bins[i] : _merge_chains(bins[i], res, comp);
+                }
+            }
+            return res;
+        }
+
+        /// Takes all nodes out of the list as a chain, the list is left empty.
+        Chain _release_chain() {
+            Chain res{_end.next, _end.prev};
+            res.last->next = nullptr;
+            _end.next = _end.prev = &_end;
+            return res;
+        }
 
+        /// Links a chain of nodes, already counted in _size, as the whole contents of the empty list.
+        void _adopt_chain(Chain chain) {
+            _end.next = chain.first;
+            _end.prev = chain.last;
+            chain.first->prev = &_end;
+            chain.last->next = &_end;
+        }
+
+        /// Moves all nodes linked to sentinel from to the empty sentinel to.
+        static void _move_links(NodeBase &from, NodeBase &to) {
+            if (from.next == &from) {
+                to.next = to.prev = &to;
+                return;
+            }
+            to.next = from.next;
+            to.prev = from.prev;
+            to.next->prev = &to;
+            to.prev->next = &to;
+            from.next = from.prev = &from;
+        }
+
+        /// Appends node to chain, an empty chain has first == nullptr.
+        static void _chain_append(Chain &chain, NodeBase *node) {
+            node->next = nullptr;
+            node->prev = chain.last;
+            if (chain.first == nullptr) {
+                chain.first = node;
+            } else {
+                chain.last->next = node;
+            }
+            chain.last = node;
+        }
+
+        /// Destroys the nodes of a chain that is not linked to any list.
+        void _destroy_chain(Chain chain) {
+            NodeBase *node = chain.first;
+            while (node != nullptr) {
+                NodeBase *next = node->next;
+                _destroy_node(node);
+                node = next;
+            }
+        }
+
+        /**
+         * Makes a chain of count nodes with elements constructed from args.
+         * If a constructor throws, the nodes made so far are destroyed.
+         */
         template<class... Args>
-        void _emplace_back(Args &&... args) {
+        Chain _make_chain(size_t count, const Args &... args) {
+            Chain chain{nullptr, nullptr};
+            try {
+                for (size_t i = 0; i < count; ++i) {
+                    _chain_append(chain, _create_node(args...));
+                }
+            } catch (...) {
+                _destroy_chain(chain);
+                throw;
+            }
+            return chain;
+        }
 
+        /**
+         * Makes a chain of nodes with elements copied from [first, last), count gets their number.
+         * If a constructor throws, the nodes made so far are destroyed.
+         */
+        template<class InputIt>
+        Chain _make_chain_from(InputIt first, InputIt last, size_t &count) {
+            Chain chain{nullptr, nullptr};
+            count = 0;
+            try {
+                for (; first != last; ++first, ++count) {
+                    _chain_append(chain, _create_node(*first));
+                }
+            } catch (...) {
+                _destroy_chain(chain);
+                throw;
+            }
+            return chain;
+        }
+
+        /**
+         * Links a chain of count nodes right before pos. Returns iterator to its first node, or pos if it is empty.
+         */
+        iterator _link_chain_before(NodeBase *pos, Chain chain, size_t count) {
+            if (chain.first == nullptr) {
+                return iterator(pos);
+            }
+            chain.first->prev = pos->prev;
+            chain.last->next = pos;
+            pos->prev->next = chain.first;
+            pos->prev = chain.last;
+            _size += count;
+            return iterator(chain.first);
+        }
+
+        /// Replaces the contents with a chain of count nodes made beforehand.
+        void _replace_with_chain(Chain chain, size_t count) {
+            clear();
+            _link_chain_before(&_end, chain, count);
         }
     };
 
     /**
      * Default constructor. Constructs an empty container with a default-constructed allocator.
      */
-    template<class T, class Alloc>
-    list<T, Alloc>::list() :
-            _allocator() {};
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    list<T, Alloc, Cache, InlineNodes>::list() :
+            _nodes() {};
 
     /**
      * Constructs an empty container with the given allocator alloc.
      */
-    template<class T, class Alloc>
-    list<T, Alloc>::list(const Alloc &alloc) :
-            _allocator(alloc) {}
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    list<T, Alloc, Cache, InlineNodes>::list(const Alloc &alloc) :
+            _nodes(_node_allocator_type(alloc)) {}
 
     /**
-     * Appends the given element value to the end of the container.
-     * The new element is initialized as a copy of value.
+     * Constructs the container with count copies of elements with value value.
      */
-    template<class T, class Alloc>
-    void list<T, Alloc>::push_back(const T &value) {
-        Node *new_node = new Node(_allocator, value);
-        if (_size == 0) {
-            _head = _tail = new_node;
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    list<T, Alloc, Cache, InlineNodes>::list(size_t count, const T &value, const Alloc &alloc):
+            _nodes(_node_allocator_type(alloc)) {
+        _link_chain_before(&_end, _make_chain(count, value), count);
+    }
+
+
+    /**
+     * Constructs the container with count default-inserted instances of T. No copies are made.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    list<T, Alloc, Cache, InlineNodes>::list(size_t count, const Alloc &alloc) :
+            _nodes(_node_allocator_type(alloc)) {
+        _link_chain_before(&_end, _make_chain(count), count);
+    }
+
+    /**
+     * Constructs the container with the contents of the range [first, last).
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    template<class InputIt, class>
+    list<T, Alloc, Cache, InlineNodes>::list(InputIt first, InputIt last, const Alloc &alloc) :
+            _nodes(_node_allocator_type(alloc)) {
+        size_t count;
+        Chain chain = _make_chain_from(first, last, count);
+        _link_chain_before(&_end, chain, count);
+    }
+
+    /**
+     * Constructs the container with the contents of the initializer list init.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    list<T, Alloc, Cache, InlineNodes>::list(std::initializer_list<T> init, const Alloc &alloc) :
+            list(init.begin(), init.end(), alloc) {}
+
+    /**
+     * Destructs the list. The destructors of the elements are called and the used storage is deallocated.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    list<T, Alloc, Cache, InlineNodes>::~list() {
+        clear();
+        shrink_to_fit();
+    }
+
+    /**
+     * Copy constructor. Constructs the container with the copy of the contents of other.
+     * The allocator is obtained by select_on_container_copy_construction of the allocator of other.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    list<T, Alloc, Cache, InlineNodes>::list(const list &other) :
+            _nodes(_node_traits::select_on_container_copy_construction(other._allocator())) {
+        size_t count;
+        Chain chain = _make_chain_from(other.begin(), other.end(), count);
+        _link_chain_before(&_end, chain, count);
+    }
+
+    /**
+     * Move constructor. Constructs the container with the contents of other using move semantics.
+     * Allocator is obtained by move-construction from the allocator belonging to other.
+     * No element is moved or copied, the nodes change their owner, spare nodes go with the allocator.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    list<T, Alloc, Cache, InlineNodes>::list(list &&other) :
+            _nodes(_take_over(other)) {
+        _move_links(other._end, _end);
+        _size = other._size;
+        other._size = 0;
+        _take_spares(other);
+    }
+
+    /**
+     * Copy assignment operator. Replaces the contents with a copy of the contents of other.
+     * Nodes that are already there are reused by assigning elements to them.
+     * The allocator is replaced by a copy of the one of other if propagate_on_container_copy_assignment is true,
+     * the nodes of the old allocator are freed first unless the two are equal.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    list<T, Alloc, Cache, InlineNodes> &list<T, Alloc, Cache, InlineNodes>::operator=(const list &other) {
+        if (this == &other) {
+            return *this;
+        }
+        if constexpr (_node_traits::propagate_on_container_copy_assignment::value) {
+            if (!_same_allocator(other)) {
+                clear();
+                shrink_to_fit();
+            }
+            _allocator() = other._allocator();
+        }
+        auto it = begin();
+        auto other_it = other.begin();
+        for (; it != end() && other_it != other.end(); ++it, ++other_it) {
+            *it = *other_it;
+        }
+        if (other_it == other.end()) {
+            erase(it, end());
         } else {
-            _tail->next = new_node;
-            _tail = new_node;
+            for (; other_it != other.end(); ++other_it) {
+                push_back(*other_it);
+            }
         }
-        _size += 1;
+        return *this;
     }
 
-    template<class T, class Alloc>
-    void list<T, Alloc>::push_back(T &&value) {
-        Node *new_node = new Node(_allocator, value);
-        if (_size == 0) {
-            _head = _tail = new_node;
+    /**
+     * Move assignment operator. Replaces the contents with those of other using move semantics, other is left empty.
+     * If propagate_on_container_move_assignment is true, the nodes and spare nodes of other are taken over
+     * with its allocator. Otherwise the nodes are taken over only if the allocators are equal;
+     * if they are not, the elements are moved one by one into nodes of the allocator of *this.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    list<T, Alloc, Cache, InlineNodes> &list<T, Alloc, Cache, InlineNodes>::operator=(list &&other) {
+        if (this == &other) {
+            return *this;
+        }
+        if constexpr (_node_traits::propagate_on_container_move_assignment::value) {
+            other._evict_inline();
+            clear();
+            shrink_to_fit();
+            _allocator() = std::move(other._allocator());
+            _take_spares(other);
+        } else if (!_same_allocator(other)) {
+            auto it = begin();
+            auto other_it = other.begin();
+            for (; it != end() && other_it != other.end(); ++it, ++other_it) {
+                *it = std::move(*other_it);
+            }
+            if (other_it == other.end()) {
+                erase(it, end());
+            } else {
+                for (; other_it != other.end(); ++other_it) {
+                    push_back(std::move(*other_it));
+                }
+            }
+            other.clear();
+            return *this;
         } else {
-            _tail->next = new_node;
-            _tail = new_node;
+            other._evict_inline();
+            clear();
         }
-        _size += 1;
+        _move_links(other._end, _end);
+        _size = other._size;
+        other._size = 0;
+        return *this;
     }
 
     /**
-     * Removes the last element of the container.
-     * Calling pop_back on an empty container results in undefined behavior.
+     * Replaces the contents with those identified by initializer list ilist.
      */
-    template<class T, class Alloc>
-    void list<T, Alloc>::pop_back() {
-        _erase(_size - 1);
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    list<T, Alloc, Cache, InlineNodes> &list<T, Alloc, Cache, InlineNodes>::operator=(std::initializer_list<T> ilist) {
+        assign(ilist);
+        return *this;
     }
 
     /**
-     * Removes the first element of the container.
+     * Replaces the contents with count copies of value value.
+     * The new nodes are made before the old ones are destroyed, so if an exception is thrown, the list is unchanged.
      */
-    template<class T, class Alloc>
-    void list<T, Alloc>::pop_front() {
-        _erase(_size - 1);
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::assign(size_t count, const T &value) {
+        _replace_with_chain(_make_chain(count, value), count);
     }
 
     /**
-     * Returns the number of elements in the container, i.e. std::distance(begin(), end()).
+     * Replaces the contents with copies of those in the range [first, last).
+     * If an exception is thrown, the list is unchanged.
      */
-    template<class T, class Alloc>
-    size_t list<T, Alloc>::size() const {
-        return _size;
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    template<class InputIt, class>
+    void list<T, Alloc, Cache, InlineNodes>::assign(InputIt first, InputIt last) {
+        size_t count;
+        Chain chain = _make_chain_from(first, last, count);
+        _replace_with_chain(chain, count);
     }
 
     /**
-     * Constructs the container with count copies of elements with value value.
+     * Replaces the contents with the elements from the initializer list ilist.
      */
-    template<class T, class Alloc>
-    list<T, Alloc>::list(size_t count, const T &value, const Alloc &alloc):
-            _allocator(alloc) {
-        while (size() != count)
-            push_back(value);
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::assign(std::initializer_list<T> ilist) {
+        assign(ilist.begin(), ilist.end());
     }
 
-
     /**
-     * Constructs the container with count default-inserted instances of T. No copies are made.
+     * Returns the allocator associated with the container.
      */
-    template<class T, class Alloc>
-    list<T, Alloc>::list(size_t count, const Alloc &alloc) {
-
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    Alloc list<T, Alloc, Cache, InlineNodes>::get_allocator() const {
+        return Alloc(_allocator());
     }
 
     /**
@@ -353,14 +1037,14 @@ namespace task {
      * Calling front on an empty container is undefined.
      * For a container c, the expression c.front() is equivalent to *c.begin().
      */
-    template<class T, class Alloc>
-    T &list<T, Alloc>::front() {
-        return *_head->data;
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    T &list<T, Alloc, Cache, InlineNodes>::front() {
+        return *begin();
     }
 
-    template<class T, class Alloc>
-    const T &list<T, Alloc>::front() const {
-        return *_head->data;
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    const T &list<T, Alloc, Cache, InlineNodes>::front() const {
+        return *begin();
     }
 
     /**
@@ -368,30 +1052,96 @@ namespace task {
      * Calling back on an empty container causes undefined behavior.
      * For a non-empty container c, the expression c.back() is equivalent to *std::prev(c.end())
      */
-    template<class T, class Alloc>
-    T &list<T, Alloc>::back() {
-        return *_tail->data;
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    T &list<T, Alloc, Cache, InlineNodes>::back() {
+        return *iterator(_end.prev);
     }
 
-    template<class T, class Alloc>
-    const T &list<T, Alloc>::back() const {
-        return *_tail->data;
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    const T &list<T, Alloc, Cache, InlineNodes>::back() const {
+        return *const_iterator(_end.prev);
+    }
+
+    /**
+     * Returns an iterator to the first element of the list.
+     * If the list is empty, the returned iterator will be equal to end().
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    typename list<T, Alloc, Cache, InlineNodes>::iterator list<T, Alloc, Cache, InlineNodes>::begin() {
+        return iterator(_end.next);
+    }
+
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    typename list<T, Alloc, Cache, InlineNodes>::const_iterator list<T, Alloc, Cache, InlineNodes>::begin() const {
+        return const_iterator(_end.next);
+    }
+
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    typename list<T, Alloc, Cache, InlineNodes>::const_iterator list<T, Alloc, Cache, InlineNodes>::cbegin() const {
+        return const_iterator(_end.next);
+    }
+
+    /**
+     * Returns an iterator to the element following the last element of the list.
+     * This element acts as a placeholder; attempting to access it results in undefined behavior.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    typename list<T, Alloc, Cache, InlineNodes>::iterator list<T, Alloc, Cache, InlineNodes>::end() {
+        return iterator(&_end);
+    }
+
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    typename list<T, Alloc, Cache, InlineNodes>::const_iterator list<T, Alloc, Cache, InlineNodes>::end() const {
+        return const_iterator(&_end);
+    }
+
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    typename list<T, Alloc, Cache, InlineNodes>::const_iterator list<T, Alloc, Cache, InlineNodes>::cend() const {
+        return const_iterator(&_end);
+    }
+
+    /**
+     * Returns a reverse iterator to the first element of the reversed list.
+     * It corresponds to the last element of the non-reversed list.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    typename list<T, Alloc, Cache, InlineNodes>::reverse_iterator list<T, Alloc, Cache, InlineNodes>::rbegin() {
+        return reverse_iterator(end());
+    }
+
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    typename list<T, Alloc, Cache, InlineNodes>::const_reverse_iterator list<T, Alloc, Cache, InlineNodes>::crbegin() const {
+        return const_reverse_iterator(cend());
+    }
+
+    /**
+     * Returns a reverse iterator to the element following the last element of the reversed list.
+     * It corresponds to the element preceding the first element of the non-reversed list.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    typename list<T, Alloc, Cache, InlineNodes>::reverse_iterator list<T, Alloc, Cache, InlineNodes>::rend() {
+        return reverse_iterator(begin());
+    }
+
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    typename list<T, Alloc, Cache, InlineNodes>::const_reverse_iterator list<T, Alloc, Cache, InlineNodes>::crend() const {
+        return const_reverse_iterator(cbegin());
     }
 
     /**
      * Checks if the container has no elements, i.e. whether begin() == end().
      */
-    template<class T, class Alloc>
-    bool list<T, Alloc>::empty() const {
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    bool list<T, Alloc, Cache, InlineNodes>::empty() const {
         return _size == 0;
     }
 
     /**
-     * Returns the allocator associated with the container.
+     * Returns the number of elements in the container, i.e. std::distance(begin(), end()).
      */
-    template<class T, class Alloc>
-    Alloc list<T, Alloc>::get_allocator() const {
-        return _allocator;
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    size_t list<T, Alloc, Cache, InlineNodes>::size() const {
+        return _size;
     }
 
     /**
@@ -401,30 +1151,534 @@ namespace task {
      * This value typically reflects the theoretical limit on the size of the container,
      * at most std::numeric_limits<difference_type>::max()
      */
-    template<class T, class Alloc>
-    size_t list<T, Alloc>::max_size() const {
-        return _traits::max_size(_allocator);
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    size_t list<T, Alloc, Cache, InlineNodes>::max_size() const {
+        return _node_traits::max_size(_allocator());
+    }
+
+    /**
+     * Erases all elements from the container. After this call, size() returns zero.
+     * Freed nodes are kept as spares while the Cache policy has room.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::clear() {
+        NodeBase *node = _end.next;
+        while (node != &_end) {
+            NodeBase *next = node->next;
+            _destroy_node(node);
+            node = next;
+        }
+        _end.next = _end.prev = &_end;
+        _size = 0;
+    }
+
+    /**
+     * Inserts value before pos. Returns iterator pointing to the inserted value.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    typename list<T, Alloc, Cache, InlineNodes>::iterator list<T, Alloc, Cache, InlineNodes>::insert(const_iterator pos, const T &value) {
+        return emplace(pos, value);
+    }
+
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    typename list<T, Alloc, Cache, InlineNodes>::iterator list<T, Alloc, Cache, InlineNodes>::insert(const_iterator pos, T &&value) {
+        return emplace(pos, std::move(value));
+    }
+
+    /**
+     * Inserts count copies of the value before pos.
+     * Returns iterator pointing to the first element inserted, or pos if count == 0.
+     * The new nodes are linked to each other first and then spliced in at once,
+     * so if an exception is thrown, the list is unchanged.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    typename list<T, Alloc, Cache, InlineNodes>::iterator list<T, Alloc, Cache, InlineNodes>::insert(const_iterator pos, size_t count, const T &value) {
+        return _link_chain_before(pos._node, _make_chain(count, value), count);
+    }
+
+    /**
+     * Inserts elements from range [first, last) before pos.
+     * Returns iterator pointing to the first element inserted, or pos if first == last.
+     * If an exception is thrown, the list is unchanged.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    template<class InputIt, class>
+    typename list<T, Alloc, Cache, InlineNodes>::iterator
+    list<T, Alloc, Cache, InlineNodes>::insert(const_iterator pos, InputIt first, InputIt last) {
+        size_t count;
+        Chain chain = _make_chain_from(first, last, count);
+        return _link_chain_before(pos._node, chain, count);
+    }
+
+    /**
+     * Inserts elements from initializer list ilist before pos.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    typename list<T, Alloc, Cache, InlineNodes>::iterator
+    list<T, Alloc, Cache, InlineNodes>::insert(const_iterator pos, std::initializer_list<T> ilist) {
+        return insert(pos, ilist.begin(), ilist.end());
+    }
+
+    /**
+     * Removes the element at pos. Returns iterator following the removed element.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    typename list<T, Alloc, Cache, InlineNodes>::iterator list<T, Alloc, Cache, InlineNodes>::erase(const_iterator pos) {
+        NodeBase *node = pos._node;
+        NodeBase *next = node->next;
+        _unlink(node);
+        _destroy_node(node);
+        _size -= 1;
+        return iterator(next);
+    }
+
+    /**
+     * Removes the elements in the range [first, last). Returns iterator following the last removed element.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    typename list<T, Alloc, Cache, InlineNodes>::iterator list<T, Alloc, Cache, InlineNodes>::erase(const_iterator first, const_iterator last) {
+        while (first != last) {
+            first = erase(first);
+        }
+        return iterator(last._node);
+    }
+
+    /**
+     * Appends the given element value to the end of the container.
+     * The new element is initialized as a copy of value.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::push_back(const T &value) {
+        emplace(cend(), value);
+    }
+
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::push_back(T &&value) {
+        emplace(cend(), std::move(value));
+    }
+
+    /**
+     * Removes the last element of the container.
+     * Calling pop_back on an empty container results in undefined behavior.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::pop_back() {
+        erase(const_iterator(_end.prev));
     }
 
-    template<class T, class Alloc>
+    /**
+     * Prepends the given element value to the beginning of the container.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::push_front(const T &value) {
+        emplace(cbegin(), value);
+    }
+
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::push_front(T &&value) {
+        emplace(cbegin(), std::move(value));
+    }
+
+    /**
+     * Removes the first element of the container.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::pop_front() {
+        erase(cbegin());
+    }
+
+    /**
+     * Inserts a new element into the container directly before pos.
+     * The element is constructed in place inside its node with std::forward<Args>(args)...
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
     template<class... Args>
-    void list<T, Alloc>::emplace_back(Args &&... args) {
+    typename list<T, Alloc, Cache, InlineNodes>::iterator list<T, Alloc, Cache, InlineNodes>::emplace(const_iterator pos, Args &&... args) {
+        Node *node = _create_node(std::forward<Args>(args)...);
+        _link_before(pos._node, node);
+        _size += 1;
+        return iterator(node);
+    }
 
+    /**
+     * Appends a new element to the end of the container, constructed in place.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    template<class... Args>
+    void list<T, Alloc, Cache, InlineNodes>::emplace_back(Args &&... args) {
+        emplace(cend(), std::forward<Args>(args)...);
+    }
+
+    /**
+     * Inserts a new element to the beginning of the container, constructed in place.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    template<class... Args>
+    void list<T, Alloc, Cache, InlineNodes>::emplace_front(Args &&... args) {
+        emplace(cbegin(), std::forward<Args>(args)...);
+    }
+
+    /**
+     * Resizes the container to contain count elements.
+     * If the current size is greater than count, the container is reduced to its first count elements.
+     * If the current size is less than count, additional default-inserted elements are appended.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::resize(size_t count) {
+        while (_size > count) {
+            pop_back();
+        }
+        while (_size < count) {
+            emplace_back();
+        }
+    }
+
+    /**
+     * Exchanges the contents of the container with those of other.
+     * Does not invoke any move, copy, or swap operations on individual elements,
+     * except that elements in inline nodes of either list are moved into allocated nodes first.
+     * The allocators, with their spare nodes, are swapped if propagate_on_container_swap is true,
+     * otherwise they must be equal.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::swap(list &other) {
+        _evict_inline();
+        other._evict_inline();
+        NodeBase tmp{&tmp, &tmp};
+        _move_links(_end, tmp);
+        _move_links(other._end, _end);
+        _move_links(tmp, other._end);
+        std::swap(_size, other._size);
+        if constexpr (_node_traits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(_allocator(), other._allocator());
+            std::swap(_nodes.spare, other._nodes.spare);
+            std::swap(_nodes.spare_count, other._nodes.spare_count);
+        }
+    }
+
+    /**
+     * Deallocates the spare nodes kept by the Cache policy. Elements are not affected.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::shrink_to_fit() {
+        while (_nodes.spare != nullptr) {
+            NodeBase *next = _nodes.spare->next;
+            _node_traits::deallocate(_allocator(), static_cast<Node *>(_nodes.spare), 1);
+            _nodes.spare = next;
+        }
+        _nodes.spare_count = 0;
+    }
+
+    /**
+     * Measures the memory used by the list and how far apart its nodes lie, walking it once.
+     * cache_lines counts the lines of cache_line bytes spanned by every node in traversal order,
+     * a line shared with the previous node is counted once; a list of nodes in address order
+     * touches about node_bytes / cache_line lines, a scattered one up to one or two per node.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    list_footprint list<T, Alloc, Cache, InlineNodes>::footprint(std::size_t cache_line) const {
+        list_footprint res;
+        res.node_bytes = (_size - _nodes.in_use()) * sizeof(Node); // inline nodes are part of object_bytes
+        res.payload_bytes = _size * sizeof(T);
+        res.spare_bytes = _nodes.spare_count * sizeof(Node);
+        res.object_bytes = sizeof(*this);
+        res.allocator_bytes = std::is_empty<_node_allocator_type>::value ? 0 : sizeof(_node_allocator_type);
+        std::uintptr_t previous_line = ~std::uintptr_t(0);
+        double distance = 0;
+        for (const NodeBase *node = _end.next; node != &_end; node = node->next) {
+            auto address = reinterpret_cast<std::uintptr_t>(node);
+            if (node != _end.next) {
+                auto previous = reinterpret_cast<std::uintptr_t>(node->prev);
+                distance += double((address > previous) ? address - previous : previous - address);
+            }
+            std::uintptr_t first_line = address / cache_line;
+            std::uintptr_t last_line = (address + sizeof(Node) - 1) / cache_line;
+            res.cache_lines += last_line - first_line + (first_line != previous_line ? 1 : 0);
+            previous_line = last_line;
+        }
+        if (_size > 1) {
+            res.mean_distance = distance / double(_size - 1);
+        }
+        return res;
+    }
+
+    /**
+     * Moves the elements into freshly allocated nodes that follow each other in address order,
+     * to restore the iteration locality lost by long churn. The new nodes are allocated at once
+     * before any element is touched, then sorted by address, so with an allocator that hands out
+     * consecutive blocks they form one contiguous run. Inline nodes and spare nodes are not reused.
+     * Elements are moved if their move constructor does not throw and copied otherwise,
+     * so if an exception is thrown, the list is unchanged. All iterators are invalidated.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::relocate_compact() {
+        if (_size == 0) {
+            return;
+        }
+        std::vector<Node *> fresh;
+        fresh.reserve(_size);
+        std::size_t built = 0;
+        try {
+            while (fresh.size() != _size) {
+                fresh.push_back(_node_traits::allocate(_allocator(), 1));
+            }
+            std::sort(fresh.begin(), fresh.end(), std::less<Node *>());
+            for (NodeBase *node = _end.next; node != &_end; node = node->next, ++built) {
+                _node_traits::construct(_allocator(), fresh[built]->value(), std::move_if_noexcept(_value(node)));
+            }
+        } catch (...) {
+            for (std::size_t i = 0; i < fresh.size(); ++i) {
+                if (i < built) {
+                    _node_traits::destroy(_allocator(), fresh[i]->value());
+                }
+                _node_traits::deallocate(_allocator(), fresh[i], 1);
+            }
+            throw;
+        }
+        NodeBase *node = _end.next;
+        while (node != &_end) { // the old nodes are freed, not kept as spares: they are the scattered ones
+            NodeBase *next = node->next;
+            auto old = static_cast<Node *>(node);
+            _node_traits::destroy(_allocator(), old->value());
+            if (_nodes.owns(old)) {
+                _nodes.give_back(old);
+            } else {
+                _node_traits::deallocate(_allocator(), old, 1);
+            }
+            node = next;
+        }
+        _end.next = _end.prev = &_end;
+        for (Node *fresh_node: fresh) {
+            _link_before(&_end, fresh_node);
+        }
     }
 
+    /**
+     * Merges two sorted lists into one. No elements are copied, other becomes empty.
+     * For equivalent elements in the two lists, the elements from *this precede the elements from other.
+     * Uses operator< to compare the elements, the overload with comp uses the given comparison function.
+     * Elements in inline nodes of other are moved into allocated nodes first.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::merge(list &other) {
+        merge(other, std::less<T>());
+    }
 
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    template<class Compare>
+    void list<T, Alloc, Cache, InlineNodes>::merge(list &other, Compare comp) {
+        if (this == &other) {
+            return;
+        }
+        other._evict_inline();
+        NodeBase *node = _end.next;
+        NodeBase *first = other._end.next;
+        while (node != &_end && first != &other._end) {
+            if (comp(_value(first), _value(node))) {
+                NodeBase *last = first->next; // splice the whole run of other that goes before node
+                while (last != &other._end && comp(_value(last), _value(node))) {
+                    last = last->next;
+                }
+                _transfer(node, first, last);
+                first = last;
+            } else {
+                node = node->next;
+            }
+        }
+        _transfer(&_end, first, &other._end);
+        _size += other._size;
+        other._size = 0;
+    }
 
+    /**
+     * Transfers all elements from other into *this before pos. No elements are copied or moved,
+     * only the internal pointers of the list nodes are re-pointed.
+     * The exception are elements in inline nodes of other, they are moved into allocated nodes first.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::splice(const_iterator pos, list &other) {
+        if (this == &other) {
+            return;
+        }
+        other._evict_inline();
+        _transfer(pos._node, other._end.next, &other._end);
+        _size += other._size;
+        other._size = 0;
+    }
 
+    /**
+     * Transfers the element pointed to by it from other into *this before pos.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::splice(const_iterator pos, list &other, const_iterator it) {
+        if (pos._node == it._node || pos._node == it._node->next) {
+            return;
+        }
+        NodeBase *node = it._node;
+        if constexpr (InlineNodes > 0) {
+            if (this != &other && other._nodes.owns(node)) {
+                node = other._evict(node);
+            }
+        }
+        _transfer(pos._node, node, node->next);
+        other._size -= 1;
+        _size += 1;
+    }
 
+    /**
+     * Transfers the elements in the range [first, last) from other into *this before pos.
+     * The behavior is undefined if pos is an iterator in the range [first, last).
+     * Linear in the length of the range when other is another list, to keep the sizes.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::splice(const_iterator pos, list &other, const_iterator first, const_iterator last) {
+        NodeBase *first_node = first._node;
+        if (this != &other && first_node != last._node) {
+            std::size_t count = other._evict_inline(first_node, last._node);
+            other._size -= count;
+            _size += count;
+        }
+        _transfer(pos._node, first_node, last._node);
+    }
 
+    /**
+     * Removes all elements equal to value, or all elements for which predicate p returns true.
+     * value may refer to an element of the list: removed nodes are destroyed after the walk.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::remove(const T &value) {
+        remove_if([&value](const T &element) { return element == value; });
+    }
 
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    template<class UnaryPredicate>
+    void list<T, Alloc, Cache, InlineNodes>::remove_if(UnaryPredicate p) {
+        NodeBase *removed = nullptr; // chain linked by next
+        NodeBase *node = _end.next;
+        while (node != &_end) {
+            NodeBase *next = node->next;
+            if (p(_value(node))) {
+                _unlink(node);
+                node->next = removed;
+                removed = node;
+                _size -= 1;
+            }
+            node = next;
+        }
+        while (removed != nullptr) {
+            NodeBase *next = removed->next;
+            _destroy_node(removed);
+            removed = next;
+        }
+    }
 
+    /**
+     * Reverses the order of the elements in the container. No references or iterators become invalidated.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::reverse() {
+        NodeBase *node = &_end;
+        do {
+            std::swap(node->prev, node->next);
+            node = node->prev; // the old next
+        } while (node != &_end);
+    }
 
+    /**
+     * Removes all consecutive duplicate elements from the container. Only the first element
+     * in each group of equal elements is left. Uses operator== or the binary predicate p.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::unique() {
+        unique(std::equal_to<T>());
+    }
 
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    template<class BinaryPredicate>
+    void list<T, Alloc, Cache, InlineNodes>::unique(BinaryPredicate p) {
+        if (_size < 2) {
+            return;
+        }
+        NodeBase *kept = _end.next;
+        NodeBase *node = kept->next;
+        while (node != &_end) {
+            NodeBase *next = node->next;
+            if (p(_value(kept), _value(node))) {
+                _unlink(node);
+                _destroy_node(node);
+                _size -= 1;
+            } else {
+                kept = node;
+            }
+            node = next;
+        }
+    }
 
+    /**
+     * Sorts the elements in ascending order. The order of equal elements is preserved.
+     * Elements are never copied or moved: nodes are relinked by a bottom-up merge sort.
+     * O(N log N) comparisons, O(1) extra memory.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::sort() {
+        sort(std::less<T>());
+    }
 
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    template<class Compare>
+    void list<T, Alloc, Cache, InlineNodes>::sort(Compare comp) {
+        if (_size < 2) {
+            return;
+        }
+        _adopt_chain(_sort_chain(_release_chain(), comp));
+    }
 
+    /**
+     * Sorts the elements like sort() on several threads given by policy.
+     * The list is cut into one run per thread, the runs are sorted concurrently and then merged
+     * pairwise, the merges of one level running concurrently too. The order of equal elements is preserved.
+     * Every thread uses its own copy of comp. If comp throws, std::terminate is called.
+     */
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    void list<T, Alloc, Cache, InlineNodes>::sort(const parallel_policy &policy) {
+        sort(policy, std::less<T>());
+    }
 
-// Your template function definitions may go here...
+    template<class T, class Alloc, class Cache, std::size_t InlineNodes>
+    template<class Compare>
+    void list<T, Alloc, Cache, InlineNodes>::sort(const parallel_policy &policy, Compare comp) {
+        std::size_t parts = policy.parts(_size);
+        if (parts < 2) {
+            sort(comp);
+            return;
+        }
+        std::vector<Chain> runs(parts);
+        NodeBase *node = _release_chain().first;
+        for (std::size_t i = 0; i < parts; ++i) {
+            std::size_t length = _size / parts + (i < _size % parts ? 1 : 0);
+            runs[i].first = node;
+            for (std::size_t j = 1; j < length; ++j) {
+                node = node->next;
+            }
+            runs[i].last = node;
+            node = node->next;
+            runs[i].last->next = nullptr;
+        }
+        run_parallel(parts, [&runs, comp](std::size_t i) mutable {
+            runs[i] = _sort_chain(runs[i], comp);
+        });
+        while (runs.size() > 1) {
+            std::vector<Chain> merged((runs.size() + 1) / 2);
+            run_parallel(runs.size() / 2, [&runs, &merged, comp](std::size_t i) mutable {
+                merged[i] = _merge_chains(runs[2 * i], runs[2 * i + 1], comp);
+            });
+            if (runs.size() % 2 != 0) {
+                merged.back() = runs.back();
+            }
+            runs.swap(merged);
+        }
+        _adopt_chain(runs[0]);
+    }
 
 }  // namespace task
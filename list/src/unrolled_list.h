@@ -0,0 +1,1149 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+
+
+namespace task {
+
+
+    /**
+     * Unrolled linked list: a doubly-linked list of blocks, each holding up to CAPACITY
+     * elements inline, packed at its start. A block is NodeBytes bytes, one or two
+     * cache lines, so a scan touches one pointer per block instead of one per element.
+     *
+     * The interface follows task::list. Differences:
+     * - inserting or erasing moves the elements of one block, so T must be move constructible,
+     *   and only iterators into that block (or the two halves of a split block) are invalidated;
+     * - iterators into other blocks, and references to their elements, stay valid;
+     * - splice of a whole list or of a range relinks whole blocks, splitting the blocks at pos and at
+     *   the ends of the range first; splice of a single element moves it into a free slot instead;
+     * - there is no sort and merge: both would have to move elements between blocks.
+     */
+    template<class T, class Alloc = std::allocator<T>, std::size_t NodeBytes = 128>
+    class unrolled_list {
+
+    private:
+        struct BlockBase;
+        struct Block;
+
+    public:
+        class const_iterator;
+
+        class iterator {
+        public:
+            using difference_type = ptrdiff_t;
+            using value_type = T;
+            using pointer = T *;
+            using reference = T &;
+            using iterator_category = std::bidirectional_iterator_tag;
+
+            iterator() = default;
+
+            iterator &operator++() {
+                if (++_index == _block->count) {
+                    _block = _block->next;
+                    _index = 0;
+                }
+                return *this;
+            }
+
+            iterator operator++(int) {
+                iterator res = *this;
+                ++*this;
+                return res;
+            }
+
+            reference operator*() const {
+                return *static_cast<Block *>(_block)->value(_index);
+            }
+
+            pointer operator->() const {
+                return static_cast<Block *>(_block)->value(_index);
+            }
+
+            iterator &operator--() {
+                if (_index == 0) {
+                    _block = _block->prev;
+                    _index = _block->count;
+                }
+                --_index;
+                return *this;
+            }
+
+            iterator operator--(int) {
+                iterator res = *this;
+                --*this;
+                return res;
+            }
+
+            bool operator==(iterator other) const {
+                return _block == other._block && _index == other._index;
+            }
+
+            bool operator!=(iterator other) const {
+                return !(*this == other);
+            }
+
+        private:
+            friend class unrolled_list;
+
+            friend class const_iterator;
+
+            BlockBase *_block = nullptr;
+            std::size_t _index = 0;
+
+            iterator(BlockBase *block, std::size_t index) : _block(block), _index(index) {}
+        };
+
+        class const_iterator {
+        public:
+            using difference_type = ptrdiff_t;
+            using value_type = T;
+            using pointer = const T *;
+            using reference = const T &;
+            using iterator_category = std::bidirectional_iterator_tag;
+
+            const_iterator() = default;
+
+            const_iterator(const iterator &other) : _block(other._block), _index(other._index) {}
+
+            const_iterator &operator++() {
+                if (++_index == _block->count) {
+                    _block = _block->next;
+                    _index = 0;
+                }
+                return *this;
+            }
+
+            const_iterator operator++(int) {
+                const_iterator res = *this;
+                ++*this;
+                return res;
+            }
+
+            reference operator*() const {
+                return *static_cast<Block *>(_block)->value(_index);
+            }
+
+            pointer operator->() const {
+                return static_cast<Block *>(_block)->value(_index);
+            }
+
+            const_iterator &operator--() {
+                if (_index == 0) {
+                    _block = _block->prev;
+                    _index = _block->count;
+                }
+                --_index;
+                return *this;
+            }
+
+            const_iterator operator--(int) {
+                const_iterator res = *this;
+                --*this;
+                return res;
+            }
+
+            bool operator==(const_iterator other) const {
+                return _block == other._block && _index == other._index;
+            }
+
+            bool operator!=(const_iterator other) const {
+                return !(*this == other);
+            }
+
+        private:
+            friend class unrolled_list;
+
+            BlockBase *_block = nullptr; // not const: the list edits blocks through const_iterator positions
+            std::size_t _index = 0;
+
+            const_iterator(const BlockBase *block, std::size_t index) :
+                    _block(const_cast<BlockBase *>(block)), _index(index) {}
+        };
+
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+
+        unrolled_list();
+
+        explicit unrolled_list(const Alloc &alloc);
+
+        unrolled_list(size_t count, const T &value, const Alloc &alloc = Alloc());
+
+        explicit unrolled_list(size_t count, const Alloc &alloc = Alloc());
+
+        ~unrolled_list();
+
+        unrolled_list(const unrolled_list &other);
+
+        unrolled_list(unrolled_list &&other);
+
+        unrolled_list &operator=(const unrolled_list &other);
+
+        unrolled_list &operator=(unrolled_list &&other);
+
+        Alloc get_allocator() const;
+
+
+        T &front();
+
+        const T &front() const;
+
+        T &back();
+
+        const T &back() const;
+
+
+        iterator begin();
+
+        iterator end();
+
+        const_iterator begin() const;
+
+        const_iterator end() const;
+
+        const_iterator cbegin() const;
+
+        const_iterator cend() const;
+
+        reverse_iterator rbegin();
+
+        reverse_iterator rend();
+
+        const_reverse_iterator crbegin() const;
+
+        const_reverse_iterator crend() const;
+
+
+        bool empty() const;
+
+        size_t size() const;
+
+        size_t max_size() const;
+
+        void clear();
+
+        iterator insert(const_iterator pos, const T &value);
+
+        iterator insert(const_iterator pos, T &&value);
+
+        iterator insert(const_iterator pos, size_t count, const T &value);
+
+        iterator erase(const_iterator pos);
+
+        iterator erase(const_iterator first, const_iterator last);
+
+
+        void push_back(const T &value);
+
+        void push_back(T &&value);
+
+        void pop_back();
+
+        void push_front(const T &value);
+
+        void push_front(T &&value);
+
+        void pop_front();
+
+        template<class... Args>
+        iterator emplace(const_iterator pos, Args &&... args);
+
+        template<class... Args>
+        void emplace_back(Args &&... args);
+
+        template<class... Args>
+        void emplace_front(Args &&... args);
+
+        void resize(size_t count);
+
+        void swap(unrolled_list &other);
+
+
+        void splice(const_iterator pos, unrolled_list &other);
+
+        void splice(const_iterator pos, unrolled_list &other, const_iterator it);
+
+        void splice(const_iterator pos, unrolled_list &other, const_iterator first, const_iterator last);
+
+        void remove(const T &value);
+
+        template<class UnaryPredicate>
+        void remove_if(UnaryPredicate p);
+
+        void reverse();
+
+        void unique();
+
+        template<class BinaryPredicate>
+        void unique(BinaryPredicate p);
+
+        /**
+         * Member types
+         */
+    private:
+        typedef std::allocator_traits<Alloc> _traits;
+    public:
+        typedef T value_type;
+        typedef Alloc allocator_type;
+        typedef typename _traits::size_type size_type;
+        typedef typename _traits::difference_type difference_type;
+        typedef value_type &reference;
+        typedef const value_type &const_reference;
+        typedef typename _traits::pointer pointer;
+        typedef typename _traits::const_pointer const_pointer;
+
+        static_assert(
+                std::is_same<typename Alloc::value_type, value_type>::value,
+                "Allocator::value_type must be same type as value_type"
+        );
+
+    private:
+        /**
+         * Links and fill of a block. The list keeps one with count 0 inside itself as the sentinel.
+         */
+        struct BlockBase {
+            BlockBase *prev;
+            BlockBase *next;
+            std::size_t count;
+        };
+
+        static_assert(NodeBytes > sizeof(BlockBase), "unrolled_list: block must fit its links");
+
+        static const std::size_t _FIT = (NodeBytes - sizeof(BlockBase)) / sizeof(T);
+
+    public:
+        /// Elements in one block.
+        static const std::size_t CAPACITY = (_FIT > 1) ? _FIT : 1;
+
+    private:
+        /**
+         * Block of up to CAPACITY elements constructed in storage by the allocator.
+         */
+        struct Block : BlockBase {
+            alignas(T) unsigned char storage[CAPACITY * sizeof(T)];
+
+            T *value(std::size_t index) {
+                return std::launder(reinterpret_cast<T *>(storage) + index);
+            }
+        };
+
+        typedef typename _traits::template rebind_alloc<Block> _block_allocator_type;
+        typedef typename _traits::template rebind_traits<Block> _block_traits;
+
+        BlockBase _end{&_end, &_end, 0};
+        std::size_t _size = 0;
+        _block_allocator_type _allocator;
+
+
+        /// Checks that blocks of other can be freed by the allocator of *this.
+        bool _same_allocator(const unrolled_list &other) const {
+            if constexpr (_block_traits::is_always_equal::value) {
+                return true;
+            } else {
+                return _allocator == other._allocator;
+            }
+        }
+
+        /// Allocates an empty block and links it right before pos.
+        Block *_create_block(BlockBase *pos) {
+            Block *block = _block_traits::allocate(_allocator, 1);
+            block->count = 0;
+            block->next = pos;
+            block->prev = pos->prev;
+            pos->prev->next = block;
+            pos->prev = block;
+            return block;
+        }
+
+        /// Unlinks an empty block and frees it.
+        void _destroy_block(BlockBase *block) {
+            block->prev->next = block->next;
+            block->next->prev = block->prev;
+            _block_traits::deallocate(_allocator, static_cast<Block *>(block), 1);
+        }
+
+        /// Moves element from of block into the free slot to of block to.
+        void _relocate(Block *from_block, std::size_t from, Block *to_block, std::size_t to) {
+            _block_traits::construct(_allocator, to_block->value(to), std::move(*from_block->value(from)));
+            _block_traits::destroy(_allocator, from_block->value(from));
+        }
+
+        /**
+         * Moves the elements of block from index on into a new block linked after it.
+         * Returns the new block.
+         */
+        Block *_split(Block *block, std::size_t index) {
+            Block *tail = _create_block(block->next);
+            for (std::size_t i = index; i < block->count; ++i) {
+                _relocate(block, i, tail, i - index);
+            }
+            tail->count = block->count - index;
+            block->count = index;
+            return tail;
+        }
+
+        /**
+         * Finds where a new element goes for an insert before pos: a block and a free slot
+         * in it, elements from the slot on already shifted one place to the right.
+         */
+        iterator _make_room(BlockBase *pos, std::size_t index) {
+            if (index == 0 && pos->prev != &_end && pos->prev->count < CAPACITY) {
+                return iterator(pos->prev, pos->prev->count); // free tail of the previous block
+            }
+            if (pos == &_end || pos->count == CAPACITY) {
+                if (index == 0) {
+                    return iterator(_create_block(pos), 0); // between two blocks
+                }
+                Block *tail = _split(static_cast<Block *>(pos), (CAPACITY + 1) / 2);
+                if (index > pos->count) {
+                    pos = tail;
+                    index -= tail->prev->count;
+                }
+            }
+            auto block = static_cast<Block *>(pos);
+            for (std::size_t i = block->count; i > index; --i) {
+                _relocate(block, i - 1, block, i);
+            }
+            return iterator(block, index);
+        }
+
+        /// Checks that _make_room(pos, index) moves elements, i.e. does not find a slot that is free already.
+        bool _moves_elements(BlockBase *pos, std::size_t index) const {
+            if (index != 0) {
+                return true;
+            }
+            return !(pos == &_end || pos->count == CAPACITY || (pos->prev != &_end && pos->prev->count < CAPACITY));
+        }
+
+        /// Closes the free slot at pos left by _make_room when constructing the element failed.
+        void _close_room(iterator pos) {
+            auto block = static_cast<Block *>(pos._block);
+            if (block->count == 0) {
+                _destroy_block(block);
+                return;
+            }
+            for (std::size_t i = pos._index; i < block->count; ++i) {
+                _relocate(block, i + 1, block, i);
+            }
+        }
+
+        /// Makes room before pos and constructs the element there from args.
+        template<class... Args>
+        iterator _emplace_at(const_iterator pos, Args &&... args) {
+            iterator slot = _make_room(pos._block, pos._index);
+            auto block = static_cast<Block *>(slot._block);
+            try {
+                _block_traits::construct(_allocator, block->value(slot._index), std::forward<Args>(args)...);
+            } catch (...) {
+                _close_room(slot);
+                throw;
+            }
+            block->count += 1;
+            _size += 1;
+            return slot;
+        }
+
+        /// Iterator to the element at index of block, or to the next element when index is past its end.
+        static iterator _normalize(BlockBase *block, std::size_t index) {
+            return (index < block->count) ? iterator(block, index) : iterator(block->next, 0);
+        }
+
+        /// Moves all blocks linked to sentinel from to the empty sentinel to.
+        static void _move_links(BlockBase &from, BlockBase &to) {
+            if (from.next == &from) {
+                to.next = to.prev = &to;
+                return;
+            }
+            to.next = from.next;
+            to.prev = from.prev;
+            to.next->prev = &to;
+            to.prev->next = &to;
+            from.next = from.prev = &from;
+        }
+    };
+
+    /**
+     * Default constructor. Constructs an empty container with a default-constructed allocator.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    unrolled_list<T, Alloc, NodeBytes>::unrolled_list() :
+            _allocator() {}
+
+    /**
+     * Constructs an empty container with the given allocator alloc.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    unrolled_list<T, Alloc, NodeBytes>::unrolled_list(const Alloc &alloc) :
+            _allocator(alloc) {}
+
+    /**
+     * Constructs the container with count copies of elements with value value.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    unrolled_list<T, Alloc, NodeBytes>::unrolled_list(size_t count, const T &value, const Alloc &alloc) :
+            _allocator(alloc) {
+        try {
+            while (size() != count)
+                push_back(value);
+        } catch (...) {
+            clear();
+            throw;
+        }
+    }
+
+    /**
+     * Constructs the container with count default-inserted instances of T. No copies are made.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    unrolled_list<T, Alloc, NodeBytes>::unrolled_list(size_t count, const Alloc &alloc) :
+            _allocator(alloc) {
+        try {
+            while (size() != count)
+                emplace_back();
+        } catch (...) {
+            clear();
+            throw;
+        }
+    }
+
+    /**
+     * Destructs the list. The destructors of the elements are called and the used storage is deallocated.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    unrolled_list<T, Alloc, NodeBytes>::~unrolled_list() {
+        clear();
+    }
+
+    /**
+     * Copy constructor. Constructs the container with the copy of the contents of other.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    unrolled_list<T, Alloc, NodeBytes>::unrolled_list(const unrolled_list &other) :
+            _allocator(other._allocator) {
+        try {
+            for (const auto &value: other) {
+                push_back(value);
+            }
+        } catch (...) {
+            clear();
+            throw;
+        }
+    }
+
+    /**
+     * Move constructor. The blocks of other change their owner, no element is moved.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    unrolled_list<T, Alloc, NodeBytes>::unrolled_list(unrolled_list &&other) :
+            _allocator(std::move(other._allocator)) {
+        _move_links(other._end, _end);
+        _size = other._size;
+        other._size = 0;
+    }
+
+    /**
+     * Copy assignment operator. Replaces the contents with a copy of the contents of other.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    unrolled_list<T, Alloc, NodeBytes> &unrolled_list<T, Alloc, NodeBytes>::operator=(const unrolled_list &other) {
+        if (this == &other) {
+            return *this;
+        }
+        auto it = begin();
+        auto other_it = other.begin();
+        for (; it != end() && other_it != other.end(); ++it, ++other_it) {
+            *it = *other_it;
+        }
+        if (other_it == other.end()) {
+            erase(it, end());
+        } else {
+            for (; other_it != other.end(); ++other_it) {
+                push_back(*other_it);
+            }
+        }
+        return *this;
+    }
+
+    /**
+     * Move assignment operator. Replaces the contents with those of other using move semantics, other is left empty.
+     * If propagate_on_container_move_assignment is true, the blocks of other are taken over with its allocator.
+     * Otherwise the blocks are taken over only if the allocators are equal;
+     * if they are not, the elements are moved one by one into blocks of the allocator of *this.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    unrolled_list<T, Alloc, NodeBytes> &unrolled_list<T, Alloc, NodeBytes>::operator=(unrolled_list &&other) {
+        if (this == &other) {
+            return *this;
+        }
+        if constexpr (_block_traits::propagate_on_container_move_assignment::value) {
+            clear();
+            _allocator = std::move(other._allocator);
+        } else if (!_same_allocator(other)) {
+            auto it = begin();
+            auto other_it = other.begin();
+            for (; it != end() && other_it != other.end(); ++it, ++other_it) {
+                *it = std::move(*other_it);
+            }
+            if (other_it == other.end()) {
+                erase(it, end());
+            } else {
+                for (; other_it != other.end(); ++other_it) {
+                    push_back(std::move(*other_it));
+                }
+            }
+            other.clear();
+            return *this;
+        } else {
+            clear();
+        }
+        _move_links(other._end, _end);
+        _size = other._size;
+        other._size = 0;
+        return *this;
+    }
+
+    /**
+     * Returns the allocator associated with the container.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    Alloc unrolled_list<T, Alloc, NodeBytes>::get_allocator() const {
+        return Alloc(_allocator);
+    }
+
+    /**
+     * Returns a reference to the first element in the container.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    T &unrolled_list<T, Alloc, NodeBytes>::front() {
+        return *begin();
+    }
+
+    template<class T, class Alloc, std::size_t NodeBytes>
+    const T &unrolled_list<T, Alloc, NodeBytes>::front() const {
+        return *begin();
+    }
+
+    /**
+     * Returns a reference to the last element in the container.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    T &unrolled_list<T, Alloc, NodeBytes>::back() {
+        return *--end();
+    }
+
+    template<class T, class Alloc, std::size_t NodeBytes>
+    const T &unrolled_list<T, Alloc, NodeBytes>::back() const {
+        return *--end();
+    }
+
+    /**
+     * Returns an iterator to the first element of the list.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    typename unrolled_list<T, Alloc, NodeBytes>::iterator unrolled_list<T, Alloc, NodeBytes>::begin() {
+        return iterator(_end.next, 0);
+    }
+
+    template<class T, class Alloc, std::size_t NodeBytes>
+    typename unrolled_list<T, Alloc, NodeBytes>::const_iterator unrolled_list<T, Alloc, NodeBytes>::begin() const {
+        return const_iterator(_end.next, 0);
+    }
+
+    template<class T, class Alloc, std::size_t NodeBytes>
+    typename unrolled_list<T, Alloc, NodeBytes>::const_iterator unrolled_list<T, Alloc, NodeBytes>::cbegin() const {
+        return const_iterator(_end.next, 0);
+    }
+
+    /**
+     * Returns an iterator to the element following the last element of the list.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    typename unrolled_list<T, Alloc, NodeBytes>::iterator unrolled_list<T, Alloc, NodeBytes>::end() {
+        return iterator(&_end, 0);
+    }
+
+    template<class T, class Alloc, std::size_t NodeBytes>
+    typename unrolled_list<T, Alloc, NodeBytes>::const_iterator unrolled_list<T, Alloc, NodeBytes>::end() const {
+        return const_iterator(&_end, 0);
+    }
+
+    template<class T, class Alloc, std::size_t NodeBytes>
+    typename unrolled_list<T, Alloc, NodeBytes>::const_iterator unrolled_list<T, Alloc, NodeBytes>::cend() const {
+        return const_iterator(&_end, 0);
+    }
+
+    /**
+     * Returns a reverse iterator to the first element of the reversed list.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    typename unrolled_list<T, Alloc, NodeBytes>::reverse_iterator unrolled_list<T, Alloc, NodeBytes>::rbegin() {
+        return reverse_iterator(end());
+    }
+
+    template<class T, class Alloc, std::size_t NodeBytes>
+    typename unrolled_list<T, Alloc, NodeBytes>::const_reverse_iterator
+    unrolled_list<T, Alloc, NodeBytes>::crbegin() const {
+        return const_reverse_iterator(cend());
+    }
+
+    /**
+     * Returns a reverse iterator to the element following the last element of the reversed list.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    typename unrolled_list<T, Alloc, NodeBytes>::reverse_iterator unrolled_list<T, Alloc, NodeBytes>::rend() {
+        return reverse_iterator(begin());
+    }
+
+    template<class T, class Alloc, std::size_t NodeBytes>
+    typename unrolled_list<T, Alloc, NodeBytes>::const_reverse_iterator
+    unrolled_list<T, Alloc, NodeBytes>::crend() const {
+        return const_reverse_iterator(cbegin());
+    }
+
+    /**
+     * Checks if the container has no elements.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    bool unrolled_list<T, Alloc, NodeBytes>::empty() const {
+        return _size == 0;
+    }
+
+    /**
+     * Returns the number of elements in the container.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    size_t unrolled_list<T, Alloc, NodeBytes>::size() const {
+        return _size;
+    }
+
+    /**
+     * Returns the maximum number of elements the container is able to hold.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    size_t unrolled_list<T, Alloc, NodeBytes>::max_size() const {
+        std::size_t blocks = _block_traits::max_size(_allocator);
+        return (blocks > std::numeric_limits<size_t>::max() / CAPACITY) ? std::numeric_limits<size_t>::max()
+                                                                         : blocks * CAPACITY;
+    }
+
+    /**
+     * Erases all elements from the container. After this call, size() returns zero.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    void unrolled_list<T, Alloc, NodeBytes>::clear() {
+        while (_end.next != &_end) {
+            auto block = static_cast<Block *>(_end.next);
+            for (std::size_t i = 0; i < block->count; ++i) {
+                _block_traits::destroy(_allocator, block->value(i));
+            }
+            block->count = 0;
+            _destroy_block(block);
+        }
+        _size = 0;
+    }
+
+    /**
+     * Inserts value before pos. Returns iterator pointing to the inserted value.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    typename unrolled_list<T, Alloc, NodeBytes>::iterator
+    unrolled_list<T, Alloc, NodeBytes>::insert(const_iterator pos, const T &value) {
+        return emplace(pos, value);
+    }
+
+    template<class T, class Alloc, std::size_t NodeBytes>
+    typename unrolled_list<T, Alloc, NodeBytes>::iterator
+    unrolled_list<T, Alloc, NodeBytes>::insert(const_iterator pos, T &&value) {
+        return emplace(pos, std::move(value));
+    }
+
+    /**
+     * Inserts count copies of the value before pos.
+     * Returns iterator pointing to the first element inserted, or pos if count == 0.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    typename unrolled_list<T, Alloc, NodeBytes>::iterator
+    unrolled_list<T, Alloc, NodeBytes>::insert(const_iterator pos, size_t count, const T &value) {
+        if (count == 0) {
+            return iterator(pos._block, pos._index);
+        }
+        if (count == 1) {
+            return emplace(pos, value);
+        }
+        const T held(value); // value may be an element that the inserts move
+        iterator res = emplace(pos, held);
+        iterator next = std::next(res);
+        for (size_t i = 1; i < count; ++i) {
+            next = std::next(emplace(next, held));
+        }
+        return std::prev(next, count);
+    }
+
+    /**
+     * Removes the element at pos. Returns iterator following the removed element.
+     * A block left empty is freed.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    typename unrolled_list<T, Alloc, NodeBytes>::iterator
+    unrolled_list<T, Alloc, NodeBytes>::erase(const_iterator pos) {
+        auto block = static_cast<Block *>(pos._block);
+        _block_traits::destroy(_allocator, block->value(pos._index));
+        for (std::size_t i = pos._index + 1; i < block->count; ++i) {
+            _relocate(block, i, block, i - 1);
+        }
+        block->count -= 1;
+        _size -= 1;
+        if (block->count == 0) {
+            BlockBase *next = block->next;
+            _destroy_block(block);
+            return iterator(next, 0);
+        }
+        return _normalize(block, pos._index);
+    }
+
+    /**
+     * Removes the elements in the range [first, last). Returns iterator following the last removed element.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    typename unrolled_list<T, Alloc, NodeBytes>::iterator
+    unrolled_list<T, Alloc, NodeBytes>::erase(const_iterator first, const_iterator last) {
+        std::size_t count = std::distance(first, last);
+        iterator res(first._block, first._index);
+        for (; count > 0; --count) {
+            res = erase(res);
+        }
+        return res;
+    }
+
+    /**
+     * Appends the given element value to the end of the container.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    void unrolled_list<T, Alloc, NodeBytes>::push_back(const T &value) {
+        emplace(cend(), value);
+    }
+
+    template<class T, class Alloc, std::size_t NodeBytes>
+    void unrolled_list<T, Alloc, NodeBytes>::push_back(T &&value) {
+        emplace(cend(), std::move(value));
+    }
+
+    /**
+     * Removes the last element of the container.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    void unrolled_list<T, Alloc, NodeBytes>::pop_back() {
+        erase(--cend());
+    }
+
+    /**
+     * Prepends the given element value to the beginning of the container.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    void unrolled_list<T, Alloc, NodeBytes>::push_front(const T &value) {
+        emplace(cbegin(), value);
+    }
+
+    template<class T, class Alloc, std::size_t NodeBytes>
+    void unrolled_list<T, Alloc, NodeBytes>::push_front(T &&value) {
+        emplace(cbegin(), std::move(value));
+    }
+
+    /**
+     * Removes the first element of the container.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    void unrolled_list<T, Alloc, NodeBytes>::pop_front() {
+        erase(cbegin());
+    }
+
+    /**
+     * Inserts a new element constructed in place before pos.
+     * Elements after pos in its block move one place, a full block is split in halves first.
+     * In that case the element is constructed in a temporary first and then moved in,
+     * so args may refer to elements of the list.
+     * If the constructor throws, the elements are moved back and the list is unchanged.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    template<class... Args>
+    typename unrolled_list<T, Alloc, NodeBytes>::iterator
+    unrolled_list<T, Alloc, NodeBytes>::emplace(const_iterator pos, Args &&... args) {
+        if (_moves_elements(pos._block, pos._index)) {
+            // args may refer to an element that _make_room moves, so the value is built before that
+            T value(std::forward<Args>(args)...);
+            return _emplace_at(pos, std::move(value));
+        }
+        return _emplace_at(pos, std::forward<Args>(args)...);
+    }
+
+    /**
+     * Appends a new element to the end of the container, constructed in place.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    template<class... Args>
+    void unrolled_list<T, Alloc, NodeBytes>::emplace_back(Args &&... args) {
+        emplace(cend(), std::forward<Args>(args)...);
+    }
+
+    /**
+     * Inserts a new element to the beginning of the container, constructed in place.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    template<class... Args>
+    void unrolled_list<T, Alloc, NodeBytes>::emplace_front(Args &&... args) {
+        emplace(cbegin(), std::forward<Args>(args)...);
+    }
+
+    /**
+     * Resizes the container to contain count elements.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    void unrolled_list<T, Alloc, NodeBytes>::resize(size_t count) {
+        while (_size > count) {
+            pop_back();
+        }
+        while (_size < count) {
+            emplace_back();
+        }
+    }
+
+    /**
+     * Exchanges the contents of the container with those of other. No element is moved.
+     * The allocators are swapped if propagate_on_container_swap is true, otherwise they must be equal.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    void unrolled_list<T, Alloc, NodeBytes>::swap(unrolled_list &other) {
+        BlockBase tmp{&tmp, &tmp, 0};
+        _move_links(_end, tmp);
+        _move_links(other._end, _end);
+        _move_links(tmp, other._end);
+        std::swap(_size, other._size);
+        if constexpr (_block_traits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(_allocator, other._allocator);
+        }
+    }
+
+    /**
+     * Transfers all elements from other into *this before pos by relinking their blocks.
+     * When pos is inside a block, the block is split there first.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    void unrolled_list<T, Alloc, NodeBytes>::splice(const_iterator pos, unrolled_list &other) {
+        if (this == &other || other.empty()) {
+            return;
+        }
+        BlockBase *at = pos._block;
+        if (pos._index != 0) {
+            at = _split(static_cast<Block *>(at), pos._index);
+        }
+        BlockBase *first = other._end.next;
+        BlockBase *last = other._end.prev;
+        other._end.next = other._end.prev = &other._end;
+        first->prev = at->prev;
+        last->next = at;
+        at->prev->next = first;
+        at->prev = last;
+        _size += other._size;
+        other._size = 0;
+    }
+
+    /**
+     * Transfers the element pointed to by it from other into *this before pos.
+     * The element is move constructed into a free slot at pos and erased from other,
+     * so splicing single elements does not leave blocks of one element behind.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    void unrolled_list<T, Alloc, NodeBytes>::splice(const_iterator pos, unrolled_list &other, const_iterator it) {
+        T &value = *static_cast<Block *>(it._block)->value(it._index);
+        if (this != &other) {
+            emplace(pos, std::move(value));
+            other.erase(it);
+            return;
+        }
+        if (pos == it || pos == std::next(it)) {
+            return;
+        }
+        T held(std::move(value));
+        BlockBase *block = pos._block;
+        std::size_t index = pos._index;
+        if (block == it._block && index > it._index) {
+            index -= 1; // erase shifts the rest of the block to the left
+        }
+        erase(it);
+        emplace(const_iterator(block, index), std::move(held));
+    }
+
+    /**
+     * Transfers the elements in the range [first, last) from other into *this before pos.
+     * The blocks at first, at last and at pos are split there, then the blocks of the range are relinked.
+     * The behavior is undefined if pos is an iterator in the range [first, last).
+     * Linear in the length of the range when other is another list, to keep the sizes.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    void unrolled_list<T, Alloc, NodeBytes>::splice(const_iterator pos, unrolled_list &other, const_iterator first,
+                                                    const_iterator last) {
+        if (first == last || (this == &other && (pos == first || pos == last))) {
+            return;
+        }
+        std::size_t count = (this != &other) ? std::distance(first, last) : 0;
+        BlockBase *at = pos._block;
+        std::size_t at_index = pos._index;
+        BlockBase *end = last._block;
+        if (last._index != 0) {
+            end = other._split(static_cast<Block *>(end), last._index);
+            if (at == last._block && at_index >= last._index) {
+                at = end; // pos was behind last in its block
+                at_index -= last._index;
+            }
+        }
+        BlockBase *begin = first._block;
+        if (first._index != 0) {
+            begin = other._split(static_cast<Block *>(begin), first._index);
+        }
+        if (at_index != 0) {
+            at = _split(static_cast<Block *>(at), at_index);
+        }
+        BlockBase *back = end->prev;
+        begin->prev->next = end;
+        end->prev = begin->prev;
+        begin->prev = at->prev;
+        back->next = at;
+        at->prev->next = begin;
+        at->prev = back;
+        other._size -= count;
+        _size += count;
+    }
+
+    /**
+     * Removes all elements equal to value, or all elements for which predicate p returns true.
+     * Kept elements are compacted to the front of their block, emptied blocks are freed.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    void unrolled_list<T, Alloc, NodeBytes>::remove(const T &value) {
+        unrolled_list removed(get_allocator()); // holds the element value refers to, if it is removed
+        const T *key = &value;
+        BlockBase *block_base = _end.next;
+        while (block_base != &_end) {
+            auto block = static_cast<Block *>(block_base);
+            BlockBase *next = block->next;
+            std::size_t kept = 0;
+            for (std::size_t i = 0; i < block->count; ++i) {
+                if (*block->value(i) == *key) {
+                    if (block->value(i) == key) {
+                        removed.push_back(std::move(*block->value(i)));
+                        key = &removed.front();
+                    }
+                    _block_traits::destroy(_allocator, block->value(i));
+                } else {
+                    if (kept != i) {
+                        _relocate(block, i, block, kept);
+                    }
+                    kept += 1;
+                }
+            }
+            _size -= block->count - kept;
+            block->count = kept;
+            if (kept == 0) {
+                _destroy_block(block);
+            }
+            block_base = next;
+        }
+    }
+
+    template<class T, class Alloc, std::size_t NodeBytes>
+    template<class UnaryPredicate>
+    void unrolled_list<T, Alloc, NodeBytes>::remove_if(UnaryPredicate p) {
+        BlockBase *block_base = _end.next;
+        while (block_base != &_end) {
+            auto block = static_cast<Block *>(block_base);
+            BlockBase *next = block->next;
+            std::size_t kept = 0;
+            for (std::size_t i = 0; i < block->count; ++i) {
+                if (p(*block->value(i))) {
+                    _block_traits::destroy(_allocator, block->value(i));
+                } else {
+                    if (kept != i) {
+                        _relocate(block, i, block, kept);
+                    }
+                    kept += 1;
+                }
+            }
+            _size -= block->count - kept;
+            block->count = kept;
+            if (kept == 0) {
+                _destroy_block(block);
+            }
+            block_base = next;
+        }
+    }
+
+    /**
+     * Reverses the order of the elements: blocks are relinked in reverse order
+     * and the elements of every block are swapped in place.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    void unrolled_list<T, Alloc, NodeBytes>::reverse() {
+        BlockBase *block = &_end;
+        do {
+            std::swap(block->prev, block->next);
+            if (block != &_end) {
+                auto full = static_cast<Block *>(block);
+                for (std::size_t i = 0, j = full->count - 1; i < j; ++i, --j) {
+                    using std::swap;
+                    swap(*full->value(i), *full->value(j));
+                }
+            }
+            block = block->prev; // the old next
+        } while (block != &_end);
+    }
+
+    /**
+     * Removes all consecutive duplicate elements from the container. Only the first element
+     * in each group of equal elements is left. Uses operator== or the binary predicate p.
+     * Kept elements are compacted to the front of their block, emptied blocks are freed.
+     */
+    template<class T, class Alloc, std::size_t NodeBytes>
+    void unrolled_list<T, Alloc, NodeBytes>::unique() {
+        unique(std::equal_to<T>());
+    }
+
+    template<class T, class Alloc, std::size_t NodeBytes>
+    template<class BinaryPredicate>
+    void unrolled_list<T, Alloc, NodeBytes>::unique(BinaryPredicate p) {
+        T *last_kept = nullptr;
+        BlockBase *block_base = _end.next;
+        while (block_base != &_end) {
+            auto block = static_cast<Block *>(block_base);
+            BlockBase *next = block->next;
+            std::size_t kept = 0;
+            for (std::size_t i = 0; i < block->count; ++i) {
+                if (last_kept != nullptr && p(*last_kept, *block->value(i))) {
+                    _block_traits::destroy(_allocator, block->value(i));
+                } else {
+                    if (kept != i) {
+                        _relocate(block, i, block, kept);
+                    }
+                    last_kept = block->value(kept);
+                    kept += 1;
+                }
+            }
+            _size -= block->count - kept;
+            block->count = kept;
+            if (kept == 0) {
+                _destroy_block(block);
+            }
+            block_base = next;
+        }
+    }
+
+}  // namespace task
@@ -2,9 +2,15 @@
 #include <string>
 #include <random>
 #include <algorithm>
+#include <numeric>
+#include <stdexcept>
 #include <vector>
 #include <list>
+#include <atomic>
+#include <thread>
 #include "src/list.h"
+#include "src/unrolled_list.h"
+#include "src/concurrent_list.h"
 
 
 size_t RandomUInt(size_t max = -1) {
@@ -62,6 +68,99 @@ struct ArgForwardTester {
 };
 
 
+struct AllocationCounts {
+    size_t allocations = 0;
+    size_t deallocations = 0;
+
+    size_t live() const { return allocations - deallocations; }
+};
+
+template <class T>
+struct CountingAllocator {
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    AllocationCounts* counts;
+
+    explicit CountingAllocator(AllocationCounts* counts) : counts(counts) {}
+
+    template <class U>
+    CountingAllocator(const CountingAllocator<U>& other) : counts(other.counts) {}
+
+    T* allocate(size_t n) {
+        counts->allocations += n;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) {
+        counts->deallocations += n;
+        std::allocator<T>().deallocate(p, n);
+    }
+};
+
+template <class T, class U>
+bool operator==(const CountingAllocator<T>& a, const CountingAllocator<U>& b) { return a.counts == b.counts; }
+
+template <class T, class U>
+bool operator!=(const CountingAllocator<T>& a, const CountingAllocator<U>& b) { return a.counts != b.counts; }
+
+
+struct Arena {
+    std::vector<unsigned char> buffer = std::vector<unsigned char>(1 << 20);
+    size_t used = 0;
+};
+
+/// Hands out consecutive blocks of one arena, deallocate does nothing.
+template <class T>
+struct ArenaAllocator {
+    using value_type = T;
+
+    Arena* arena;
+
+    explicit ArenaAllocator(Arena* arena) : arena(arena) {}
+
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) {
+        size_t start = (arena->used + alignof(T) - 1) / alignof(T) * alignof(T);
+        if (start + n * sizeof(T) > arena->buffer.size()) {
+            throw std::bad_alloc();
+        }
+        arena->used = start + n * sizeof(T);
+        return reinterpret_cast<T*>(arena->buffer.data() + start);
+    }
+
+    void deallocate(T*, size_t) {}
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena == b.arena; }
+
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena != b.arena; }
+
+
+struct ThrowOnCopy {
+    static size_t copies_left; // the copy that brings it to 0 throws, 0 means never
+
+    size_t value;
+
+    ThrowOnCopy(size_t value) : value(value) {}
+
+    ThrowOnCopy(const ThrowOnCopy& other) : value(other.value) {
+        if (copies_left > 0 && --copies_left == 0) {
+            throw std::runtime_error("copy");
+        }
+    }
+
+    bool operator==(const ThrowOnCopy& other) const { return value == other.value; }
+};
+
+size_t ThrowOnCopy::copies_left = 0;
+
+
 void FailWithMsg(const std::string& msg, int line) {
     std::cerr << "Test failed!\n";
     std::cerr << "[Line " << line << "] "  << msg << std::endl;
@@ -331,4 +430,538 @@ int main() {
         }
     }
 
+    {
+        task::unrolled_list<size_t> list_task;
+        std::list<size_t> list_std;
+        task::unrolled_list<size_t> other_task;
+        std::list<size_t> other_std;
+
+        for (size_t iter = 0; iter < 4000; ++iter) {
+            size_t pos = RandomUInt(list_std.size());
+            switch (RandomUInt(6)) {
+                case 0:
+                case 1: {
+                    auto val = RandomUInt(3);
+                    list_task.insert(std::next(list_task.begin(), pos), val);
+                    list_std.insert(std::next(list_std.begin(), pos), val);
+                    other_task.push_front(val);
+                    other_std.push_front(val);
+                    break;
+                }
+                case 2:
+                    if (pos < list_std.size()) {
+                        list_task.erase(std::next(list_task.begin(), pos));
+                        list_std.erase(std::next(list_std.begin(), pos));
+                    }
+                    break;
+                case 3:
+                    if (!other_std.empty()) {
+                        size_t it = RandomUInt(other_std.size() - 1);
+                        list_task.splice(std::next(list_task.cbegin(), pos), other_task, std::next(other_task.cbegin(), it));
+                        list_std.splice(std::next(list_std.cbegin(), pos), other_std, std::next(other_std.cbegin(), it));
+                    }
+                    break;
+                case 4: {
+                    size_t first = RandomUInt(other_std.size());
+                    size_t last = RandomUInt(first, other_std.size());
+                    list_task.splice(std::next(list_task.cbegin(), pos), other_task,
+                                     std::next(other_task.cbegin(), first), std::next(other_task.cbegin(), last));
+                    list_std.splice(std::next(list_std.cbegin(), pos), other_std,
+                                    std::next(other_std.cbegin(), first), std::next(other_std.cbegin(), last));
+                    break;
+                }
+                case 5:
+                    if (TossCoin()) {
+                        list_task.unique();
+                        list_std.unique();
+                    } else {
+                        other_task.splice(other_task.cend(), list_task);
+                        other_std.splice(other_std.cend(), list_std);
+                    }
+                    break;
+            }
+            ASSERT_EQUAL_MSG(list_task, list_std, "unrolled_list insert / erase / splice")
+            ASSERT_EQUAL_MSG(other_task, other_std, "unrolled_list splice")
+            ASSERT_TRUE(list_task.size() == list_std.size() && other_task.size() == other_std.size())
+        }
+    }
+
+
+    {
+        using List = task::unrolled_list<size_t>;
+        List list;
+        for (size_t i = 0; i < 10 * List::CAPACITY; ++i) {
+            list.push_back(i);
+        }
+        // push_back fills blocks in turn, so the first and the last elements are in different blocks
+        auto first = list.begin();
+        auto second = std::next(first);
+        const size_t *address = &*second;
+
+        auto last = std::prev(list.end(), 2);
+        for (size_t i = 0; i < 3 * List::CAPACITY; ++i) {
+            last = std::next(list.insert(last, i));
+        }
+        for (size_t i = 0; i < 2 * List::CAPACITY; ++i) {
+            list.erase(std::prev(list.end()));
+        }
+        list.push_back(42);
+
+        ASSERT_TRUE_MSG(first == list.begin() && std::next(first) == second, "unrolled_list iterator stability")
+        ASSERT_TRUE_MSG(*first == 0 && *second == 1 && &*second == address, "unrolled_list iterator stability")
+    }
+
+
+    {
+        task::unrolled_list<std::string> list_task;
+        std::list<std::string> list_std;
+
+        for (size_t iter = 0; iter < 2000; ++iter) {
+            if (list_std.empty()) {
+                auto val = std::string(32, 'a') + std::to_string(iter);
+                list_task.push_back(val);
+                list_std.push_back(val);
+                continue;
+            }
+            size_t pos = RandomUInt(list_std.size());
+            size_t src = RandomUInt(list_std.size() - 1);
+            auto &src_task = *std::next(list_task.begin(), src);
+            auto &src_std = *std::next(list_std.begin(), src);
+            switch (RandomUInt(4)) {
+                case 0:
+                    list_task.insert(std::next(list_task.begin(), pos), src_task);
+                    list_std.insert(std::next(list_std.begin(), pos), src_std);
+                    break;
+                case 1:
+                    list_task.push_front(list_task.back());
+                    list_std.push_front(list_std.back());
+                    break;
+                case 2:
+                    list_task.insert(std::next(list_task.begin(), pos), 3, src_task);
+                    list_std.insert(std::next(list_std.begin(), pos), 3, src_std);
+                    break;
+                case 3:
+                    list_task.emplace(std::next(list_task.begin(), pos), src_task, 1);
+                    list_std.emplace(std::next(list_std.begin(), pos), src_std, 1);
+                    break;
+                case 4:
+                    list_task.erase(std::next(list_task.begin(), src));
+                    list_std.erase(std::next(list_std.begin(), src));
+                    list_task.push_back(std::string(32, 'b') + std::to_string(iter));
+                    list_std.push_back(std::string(32, 'b') + std::to_string(iter));
+                    break;
+            }
+            ASSERT_EQUAL_MSG(list_task, list_std, "unrolled_list insert of its own element")
+            if (list_std.size() > 500) {
+                list_task.erase(std::next(list_task.begin(), 100), list_task.end());
+                list_std.erase(std::next(list_std.begin(), 100), list_std.end());
+            }
+        }
+    }
+
+
+    {
+        task::concurrent_list<size_t> list_task;
+        std::list<size_t> list_std;
+
+        for (size_t iter = 0; iter < 10000; ++iter) {
+            auto val = RandomUInt();
+            switch (RandomUInt(2)) {
+                case 0:
+                    list_task.push_back(val);
+                    list_std.push_back(val);
+                    break;
+                case 1:
+                    list_task.push_front(val);
+                    list_std.push_front(val);
+                    break;
+                case 2: {
+                    size_t popped = 0;
+                    ASSERT_TRUE_MSG(list_task.try_pop_front(popped) == !list_std.empty(), "concurrent_list::try_pop_front")
+                    if (!list_std.empty()) {
+                        ASSERT_TRUE_MSG(popped == list_std.front(), "concurrent_list::try_pop_front")
+                        list_std.pop_front();
+                    }
+                    break;
+                }
+            }
+        }
+        for (size_t val: list_std) {
+            size_t popped = 0;
+            ASSERT_TRUE_MSG(list_task.try_pop_front(popped) && popped == val, "concurrent_list order")
+        }
+        ASSERT_TRUE(list_task.empty())
+    }
+
+
+    {
+        const size_t PRODUCERS = 4;
+        const size_t CONSUMERS = 4;
+        const size_t PER_PRODUCER = 20000;
+
+        task::concurrent_list<size_t> list;
+        std::vector<std::vector<size_t>> popped(CONSUMERS);
+        std::atomic<size_t> done{0};
+
+        std::vector<std::thread> threads;
+        for (size_t producer = 0; producer < PRODUCERS; ++producer) {
+            threads.emplace_back([&list, producer]() {
+                for (size_t i = 0; i < PER_PRODUCER; ++i) {
+                    if (i % 2 == 0) {
+                        list.push_back(producer * PER_PRODUCER + i);
+                    } else {
+                        list.push_front(producer * PER_PRODUCER + i);
+                    }
+                }
+            });
+        }
+        for (size_t consumer = 0; consumer < CONSUMERS; ++consumer) {
+            threads.emplace_back([&list, &popped, &done, consumer]() {
+                size_t value;
+                while (done.load() < PRODUCERS * PER_PRODUCER) {
+                    if (list.try_pop_front(value)) {
+                        popped[consumer].push_back(value);
+                        done.fetch_add(1);
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+
+        std::vector<size_t> all;
+        for (auto &values: popped) {
+            all.insert(all.end(), values.begin(), values.end());
+        }
+        std::sort(all.begin(), all.end());
+        ASSERT_TRUE_MSG(all.size() == PRODUCERS * PER_PRODUCER, "concurrent_list lost or duplicated an element")
+        for (size_t i = 0; i < all.size(); ++i) {
+            ASSERT_TRUE_MSG(all[i] == i, "concurrent_list lost or duplicated an element")
+        }
+        ASSERT_TRUE(list.empty())
+    }
+
+
+    {
+        AllocationCounts counts;
+        CountingAllocator<size_t> alloc(&counts);
+        using List = task::list<size_t, CountingAllocator<size_t>, task::node_cache<8>>;
+        {
+            List list(alloc);
+            std::list<size_t> list_std;
+            for (size_t i = 0; i < 8; ++i) {
+                list.push_back(i);
+                list_std.push_back(i);
+            }
+            ASSERT_TRUE_MSG(counts.allocations == 8, "node_cache")
+
+            for (size_t i = 0; i < 4; ++i) {
+                list.erase(std::next(list.begin()));
+                list_std.erase(std::next(list_std.begin()));
+            }
+            for (size_t i = 0; i < 4; ++i) {
+                list.insert(list.begin(), 100 + i);
+                list_std.insert(list_std.begin(), 100 + i);
+            }
+            ASSERT_TRUE_MSG(counts.allocations == 8 && counts.deallocations == 0, "node_cache reuses erased nodes")
+            ASSERT_EQUAL_MSG(list, list_std, "node_cache")
+
+            list.clear();
+            ASSERT_TRUE_MSG(counts.live() == 8, "node_cache keeps spares")
+
+            List other(alloc);
+            other.push_back(1);
+            other = std::move(list); // other's node goes to its spares, then they are freed and list's are taken
+            ASSERT_TRUE_MSG(counts.live() == 8, "node_cache move assignment")
+            for (size_t i = 0; i < 8; ++i) {
+                other.push_back(i);
+            }
+            ASSERT_TRUE_MSG(counts.allocations == 9, "node_cache spares handed over by move assignment")
+
+            List moved(std::move(other));
+            moved.clear();
+            for (size_t i = 0; i < 8; ++i) {
+                moved.push_back(i);
+            }
+            ASSERT_TRUE_MSG(counts.allocations == 9, "node_cache spares handed over by move construction")
+
+            list.swap(moved); // list gets the elements, moved gets no spares
+            list.clear();
+            moved.push_back(1);
+            ASSERT_TRUE_MSG(counts.allocations == 10, "node_cache spares swapped")
+            list.push_back(1);
+            ASSERT_TRUE_MSG(counts.allocations == 10, "node_cache spares swapped")
+
+            list = moved; // copy assignment keeps the allocator and the spares
+            ASSERT_TRUE_MSG(counts.allocations == 10 && list.size() == 1, "node_cache copy assignment")
+
+            list.shrink_to_fit();
+            moved.shrink_to_fit();
+            ASSERT_TRUE_MSG(counts.live() == 2, "shrink_to_fit returns every spare")
+        }
+        ASSERT_TRUE_MSG(counts.live() == 0, "node_cache frees spares with the list")
+    }
+
+
+    {
+        AllocationCounts counts;
+        CountingAllocator<ThrowOnCopy> alloc(&counts);
+        using List = task::list<ThrowOnCopy, CountingAllocator<ThrowOnCopy>>;
+        const std::vector<ThrowOnCopy> source = {10, 11, 12, 13, 14, 15};
+        const std::vector<ThrowOnCopy> before = {0, 1, 2};
+
+        List list(before.begin(), before.end(), alloc);
+        for (size_t nth = 1; nth <= source.size(); ++nth) {
+            for (int operation = 0; operation < 4; ++operation) {
+                bool thrown = false;
+                ThrowOnCopy::copies_left = nth;
+                try {
+                    switch (operation) {
+                        case 0:
+                            list.assign(source.begin(), source.end());
+                            break;
+                        case 1:
+                            list.insert(std::next(list.begin()), source.begin(), source.end());
+                            break;
+                        case 2:
+                            list.insert(list.end(), source.size(), source.front());
+                            break;
+                        case 3:
+                            List copy(source.begin(), source.end(), alloc);
+                            break;
+                    }
+                } catch (const std::runtime_error&) {
+                    thrown = true;
+                }
+                ThrowOnCopy::copies_left = 0;
+                ASSERT_TRUE_MSG(thrown, "Nth copy constructor throws")
+                ASSERT_EQUAL_MSG(list, before, "list unchanged after a throwing copy")
+                ASSERT_TRUE_MSG(list.size() == before.size(), "list unchanged after a throwing copy")
+                ASSERT_TRUE_MSG(counts.live() == before.size(), "nodes of a throwing copy are freed")
+            }
+        }
+    }
+
+
+    {
+        using Pair = std::pair<size_t, size_t>;
+        auto by_key = [](const Pair& a, const Pair& b) { return a.first < b.first; };
+        const task::parallel_policy policy{4, 1};
+
+        for (size_t count: std::vector<size_t>{0, 1, 3, 5, 1000, RandomUInt(5000, 20000)}) {
+            task::list<Pair> list_task;
+            std::list<Pair> list_std;
+            for (size_t i = 0; i < count; ++i) {
+                Pair value(RandomUInt(50), i); // many equal keys, second keeps the original order
+                list_task.push_back(value);
+                list_std.push_back(value);
+            }
+
+            list_task.sort(policy, by_key);
+            list_std.sort(by_key);
+            ASSERT_EQUAL_MSG(list_task, list_std, "parallel sort is stable")
+
+            auto it_std = list_std.end();
+            for (auto it = list_task.end(); it != list_task.begin();) {
+                --it;
+                --it_std;
+                ASSERT_TRUE_MSG(*it == *it_std, "parallel sort prev links")
+            }
+
+            task::parallel_for_each(policy, list_task.begin(), list_task.end(), [](Pair& value) { value.first *= 3; });
+            for (auto& value: list_std) {
+                value.first *= 3;
+            }
+            ASSERT_EQUAL_MSG(list_task, list_std, "parallel_for_each")
+
+            auto sum = task::parallel_transform_reduce(policy, list_task.begin(), list_task.end(), size_t(7),
+                                                       std::plus<size_t>(), [](const Pair& value) { return value.first; });
+            size_t sum_std = 7;
+            for (auto& value: list_std) {
+                sum_std += value.first;
+            }
+            ASSERT_TRUE_MSG(sum == sum_std, "parallel_transform_reduce")
+
+            task::list<size_t> keys;
+            for (auto& value: list_std) {
+                keys.push_back(value.first);
+            }
+            ASSERT_TRUE_MSG(task::parallel_reduce(policy, keys.begin(), keys.end(), size_t(7)) == sum_std, "parallel_reduce")
+            ASSERT_TRUE_MSG(task::parallel_reduce(policy, keys.begin(), keys.end(), size_t(0),
+                                                  [](size_t a, size_t b) { return std::max(a, b); })
+                            == (keys.empty() ? 0 : *std::max_element(keys.begin(), keys.end())), "parallel_reduce with op")
+        }
+    }
+
+
+    {
+        AllocationCounts counts;
+        CountingAllocator<size_t> alloc(&counts);
+        using List = task::list<size_t, CountingAllocator<size_t>, task::no_node_cache, 4>;
+        {
+            List list(alloc);
+            for (size_t round = 0; round < 10; ++round) {
+                for (size_t i = 0; i < 4; ++i) {
+                    list.push_back(i);
+                }
+                list.pop_front();
+                list.push_front(5);
+                list.reverse();
+                list.sort();
+                list.clear();
+            }
+            ASSERT_TRUE_MSG(counts.allocations == 0, "list of at most InlineNodes elements does not allocate")
+        }
+
+        std::vector<List> lists_task;
+        lists_task.reserve(2);
+        lists_task.emplace_back(alloc);
+        lists_task.emplace_back(alloc);
+        std::vector<std::list<size_t>> lists_std(2);
+
+        for (size_t iter = 0; iter < 4000; ++iter) {
+            size_t a = RandomUInt(1);
+            size_t b = 1 - a;
+            List& task_a = lists_task[a];
+            List& task_b = lists_task[b];
+            std::list<size_t>& std_a = lists_std[a];
+            std::list<size_t>& std_b = lists_std[b];
+            size_t pos = RandomUInt(std_a.size());
+
+            switch (RandomUInt(9)) {
+                case 0:
+                case 1: {
+                    auto val = RandomUInt(20);
+                    task_a.insert(std::next(task_a.begin(), pos), val);
+                    std_a.insert(std::next(std_a.begin(), pos), val);
+                    break;
+                }
+                case 2:
+                    if (pos < std_a.size()) {
+                        task_a.erase(std::next(task_a.begin(), pos));
+                        std_a.erase(std::next(std_a.begin(), pos));
+                    }
+                    break;
+                case 3:
+                    task_a.splice(std::next(task_a.cbegin(), pos), task_b);
+                    std_a.splice(std::next(std_a.cbegin(), pos), std_b);
+                    break;
+                case 4:
+                    if (!std_b.empty()) {
+                        size_t it = RandomUInt(std_b.size() - 1);
+                        task_a.splice(std::next(task_a.cbegin(), pos), task_b, std::next(task_b.cbegin(), it));
+                        std_a.splice(std::next(std_a.cbegin(), pos), std_b, std::next(std_b.cbegin(), it));
+                    } else if (!std_a.empty()) {
+                        size_t it = RandomUInt(std_a.size() - 1);
+                        task_a.splice(std::next(task_a.cbegin(), pos), task_a, std::next(task_a.cbegin(), it));
+                        std_a.splice(std::next(std_a.cbegin(), pos), std_a, std::next(std_a.cbegin(), it));
+                    }
+                    break;
+                case 5: {
+                    size_t first = RandomUInt(std_b.size());
+                    size_t last = RandomUInt(first, std_b.size());
+                    task_a.splice(std::next(task_a.cbegin(), pos), task_b,
+                                  std::next(task_b.cbegin(), first), std::next(task_b.cbegin(), last));
+                    std_a.splice(std::next(std_a.cbegin(), pos), std_b,
+                                 std::next(std_b.cbegin(), first), std::next(std_b.cbegin(), last));
+                    break;
+                }
+                case 6:
+                    task_a.swap(task_b);
+                    std_a.swap(std_b);
+                    break;
+                case 7:
+                    if (TossCoin()) {
+                        List moved(std::move(task_a));
+                        task_a = std::move(task_b);
+                        task_b = std::move(moved);
+                    } else {
+                        task_a = std::move(task_b);
+                        std_a = std::move(std_b);
+                        std_b.clear();
+                        break;
+                    }
+                    std_a.swap(std_b);
+                    break;
+                case 8:
+                    task_a.sort();
+                    task_b.sort();
+                    std_a.sort();
+                    std_b.sort();
+                    task_a.merge(task_b);
+                    std_a.merge(std_b);
+                    break;
+                case 9:
+                    if (std_a.size() > 20) {
+                        task_a.erase(std::next(task_a.begin(), 10), task_a.end());
+                        std_a.erase(std::next(std_a.begin(), 10), std_a.end());
+                    }
+                    break;
+            }
+            for (size_t list = 0; list < 2; ++list) {
+                ASSERT_EQUAL_MSG(lists_task[list], lists_std[list], "list with inline nodes")
+                ASSERT_TRUE_MSG(lists_task[list].size() == lists_std[list].size(), "list with inline nodes")
+                ASSERT_TRUE_MSG(std::equal(lists_task[list].crbegin(), lists_task[list].crend(),
+                                           lists_std[list].crbegin(), lists_std[list].crend()), "list with inline nodes")
+            }
+        }
+        lists_task.clear();
+        ASSERT_TRUE_MSG(counts.live() == 0, "list with inline nodes frees its nodes")
+    }
+
+
+    {
+        Arena arena;
+        ArenaAllocator<size_t> alloc(&arena);
+        task::list<size_t, ArenaAllocator<size_t>> plain(alloc);
+        task::list<size_t, ArenaAllocator<size_t>, task::no_node_cache, 2> with_inline(alloc);
+        for (size_t i = 0; i < 10; ++i) {
+            plain.push_back(i);
+            with_inline.push_back(i);
+        }
+        auto plain_footprint = plain.footprint();
+        auto inline_footprint = with_inline.footprint();
+        ASSERT_TRUE_MSG(plain_footprint.payload_bytes == 10 * sizeof(size_t), "footprint payload")
+        ASSERT_TRUE_MSG(inline_footprint.node_bytes == plain_footprint.node_bytes / 10 * 8,
+                        "footprint counts inline nodes only in object_bytes")
+        ASSERT_TRUE_MSG(inline_footprint.object_bytes == sizeof(with_inline), "footprint object")
+    }
+
+
+    {
+        Arena arena;
+        ArenaAllocator<size_t> alloc(&arena);
+        task::list<size_t, ArenaAllocator<size_t>> list_task(alloc);
+        task::list<size_t, ArenaAllocator<size_t>> other(alloc);
+        std::list<size_t> list_std;
+        for (size_t i = 0; i < 1000; ++i) { // the nodes of the two lists interleave in the arena
+            auto val = RandomUInt();
+            size_t pos = RandomUInt(list_std.size());
+            list_task.insert(std::next(list_task.begin(), pos), val);
+            list_std.insert(std::next(list_std.begin(), pos), val);
+            other.push_back(val);
+        }
+        list_task.remove_if([](size_t val) { return val % 3 == 0; });
+        list_std.remove_if([](size_t val) { return val % 3 == 0; });
+        auto scattered = list_task.footprint();
+
+        list_task.relocate_compact();
+        ASSERT_EQUAL_MSG(list_task, list_std, "relocate_compact keeps the order")
+        ASSERT_TRUE_MSG(list_task.size() == list_std.size(), "relocate_compact keeps the size")
+
+        auto compact = list_task.footprint();
+        size_t stride = compact.node_bytes / list_task.size();
+        for (auto it = list_task.begin(); std::next(it) != list_task.end(); ++it) {
+            auto address = reinterpret_cast<uintptr_t>(&*it);
+            auto next_address = reinterpret_cast<uintptr_t>(&*std::next(it));
+            ASSERT_TRUE_MSG(next_address == address + stride, "relocate_compact makes the nodes contiguous")
+        }
+        ASSERT_TRUE_MSG(compact.mean_distance == double(stride), "footprint mean_distance")
+        ASSERT_TRUE_MSG(compact.mean_distance < scattered.mean_distance, "footprint mean_distance")
+        ASSERT_TRUE_MSG(compact.cache_lines <= scattered.cache_lines, "footprint cache_lines")
+    }
+
 }
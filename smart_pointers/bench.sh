@@ -0,0 +1,6 @@
+#!/bin/bash
+
+set -e
+
+g++ -std=c++17 -O2 -I./ bench/contention.cpp -o smart_pointers_contention_bench -pthread
+./smart_pointers_contention_bench "$@"
@@ -0,0 +1,60 @@
+#include "src/smart_pointers.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * Every thread copies and destroys a copy of its own SharedPtr n times; with Shared all threads
+ * copy one pointer, so they all change the counter of one control block.
+ * Returns wall-clock nanoseconds per copy and destroy pair, divided by the number of threads.
+ */
+template<class Ptr, bool Shared>
+double copy_destroy(int threads, std::size_t n) {
+    Ptr common(new int(1));
+    std::vector<Ptr> own;
+    for (int i = 0; i < threads; ++i) {
+        own.emplace_back(new int(1));
+    }
+    auto start = Clock::now();
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i) {
+        const Ptr &source = Shared ? common : own[i];
+        workers.emplace_back([&source, n]() {
+            for (std::size_t k = 0; k < n; ++k) {
+                Ptr copy(source);
+                asm volatile("" : : "r"(copy.get()) : "memory");
+            }
+        });
+    }
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / double(n) / threads;
+}
+
+template<class Ptr>
+void report(const char *name, int threads, std::size_t n) {
+    std::printf("%-26s %8d %12.2f %12.2f\n", name, threads, copy_destroy<Ptr, false>(threads, n),
+                copy_destroy<Ptr, true>(threads, n));
+}
+
+
+int main(int argc, char **argv) {
+    std::size_t n = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+
+    std::printf("%u hardware threads, ns per copy + destroy\n", std::thread::hardware_concurrency());
+    std::printf("%-26s %8s %12s %12s\n", "pointer", "threads", "own", "one shared");
+    report<task::SharedPtr<int, task::PlainCounter>>("SharedPtr<PlainCounter>", 1, n);
+    for (int threads = 1; threads <= 8; threads *= 2) {
+        report<task::SharedPtr<int>>("SharedPtr<AtomicCounter>", threads, n);
+        report<std::shared_ptr<int>>("std::shared_ptr", threads, n);
+    }
+    return 0;
+}
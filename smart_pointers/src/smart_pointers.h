@@ -1,20 +1,96 @@
 #pragma once
 
+#include <atomic>
 #include <utility>
 
 namespace task {
 
+    /**
+     * Reference counter that may be changed from several threads at once.
+     * Taking a reference needs no ordering, as the taker already holds one; dropping one is acq_rel,
+     * so the thread that drops the last reference sees every write made through the others.
+     */
+    class AtomicCounter {
+    private:
+        std::atomic<long> value;
+
+    public:
+        explicit AtomicCounter(long value) noexcept: value(value) {}
+
+        long get() const noexcept {
+            return value.load(std::memory_order_relaxed);
+        }
+
+        void increment() noexcept {
+            value.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /// Returns the value after the decrement.
+        long decrement() noexcept {
+            return value.fetch_sub(1, std::memory_order_acq_rel) - 1;
+        }
+
+        /// Increments the counter unless it is already 0, which means the object is gone for good.
+        bool increment_if_not_zero() noexcept {
+            long current = value.load(std::memory_order_relaxed);
+            while (current != 0) {
+                if (value.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel,
+                                                std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    /**
+     * Reference counter for pointers that never leave one thread: plain arithmetic, no atomic operations.
+     */
+    class PlainCounter {
+    private:
+        long value;
+
+    public:
+        explicit PlainCounter(long value) noexcept: value(value) {}
+
+        long get() const noexcept {
+            return value;
+        }
+
+        void increment() noexcept {
+            value += 1;
+        }
+
+        long decrement() noexcept {
+            return --value;
+        }
+
+        bool increment_if_not_zero() noexcept {
+            if (value == 0) {
+                return false;
+            }
+            value += 1;
+            return true;
+        }
+    };
+
+    /**
+     * Counters shared by the SharedPtr-s and WeakPtr-s of one object. The block is made by the first SharedPtr.
+     * weak_ptr_counter counts the WeakPtr-s plus one for all SharedPtr-s together, so the last SharedPtr
+     * deletes the object and then drops that one, and whoever takes weak_ptr_counter to 0 deletes the block.
+     */
+    template<class Counter = AtomicCounter>
     struct ControlBlock {
-        long shared_ptr_counter = 0;
-        long weak_ptr_counter = 0;
+        Counter shared_ptr_counter{1};
+        Counter weak_ptr_counter{1};
 
         ControlBlock() = default;
     };
 
-    template<class T>
+    template<class T, class Counter = AtomicCounter>
     class WeakPtr;
 
-    template<class T>
+    template<class T, class Counter = AtomicCounter>
     class SharedPtr;
 
     /**
@@ -103,18 +179,23 @@ namespace task {
     /**
      * SharedPtr is a smart pointer that retains shared ownership of an object through a pointer.
      * Several SharedPtr objects may own the same object.
+     * Counter is the reference counter type: AtomicCounter, the default, lets copies of one SharedPtr
+     * be made and destroyed in different threads; PlainCounter is faster for pointers used by one thread.
      */
 
-    template<class T>
+    template<class T, class Counter>
     class SharedPtr {
     public:
         using pointer = T *;
         using element_type = T;
-        using weak_type = WeakPtr<T>;
-        friend WeakPtr<T>;
+        using weak_type = WeakPtr<T, Counter>;
+        friend WeakPtr<T, Counter>;
     private:
         pointer current_ptr = nullptr;
-        ControlBlock *control_block = nullptr;
+        ControlBlock<Counter> *control_block = nullptr;
+
+        /// Drops the reference of *this to its object, if any.
+        void release() noexcept;
     public:
 
         // constructors
@@ -141,9 +222,9 @@ namespace task {
         SharedPtr(SharedPtr &&r) noexcept;
 
         /**
-         *  Constructs a shared_ptr from WeakPtr.
+         *  Constructs a shared_ptr from WeakPtr. If the object of w was already deleted, *this is empty.
          */
-        SharedPtr(const WeakPtr<T> &w) noexcept;
+        SharedPtr(const WeakPtr<T, Counter> &w) noexcept;
 
 
         /**
@@ -220,16 +301,16 @@ namespace task {
      * in order to access the referenced object.
      */
 
-    template<class T>
+    template<class T, class Counter>
     class WeakPtr {
     public:
         using pointer = T *;
         using element_type = T;
 
-        friend SharedPtr<T>;
+        friend SharedPtr<T, Counter>;
     private:
         pointer current_ptr = nullptr;
-        ControlBlock *control_block = nullptr;
+        ControlBlock<Counter> *control_block = nullptr;
     public:
         // constructors
 
@@ -242,7 +323,7 @@ namespace task {
          * Constructs new weak_ptr which shares an object managed by r.
          * If r manages no object, *this manages no object too.
          */
-        WeakPtr(const SharedPtr<T> &s) noexcept;
+        WeakPtr(const SharedPtr<T, Counter> &s) noexcept;
 
         /**
          * Constructs new weak_ptr which shares an object managed by r.
@@ -267,7 +348,7 @@ namespace task {
          */
         WeakPtr &operator=(const WeakPtr &r) noexcept;
 
-        WeakPtr &operator=(const SharedPtr<T> &r) noexcept;
+        WeakPtr &operator=(const SharedPtr<T, Counter> &r) noexcept;
 
         /**
          * Move operator=.
@@ -291,8 +372,9 @@ namespace task {
         /**
          * Creates a new std::shared_ptr that shares ownership of the managed object.
          * If there is no managed object, i.e. *this is empty, then the returned shared_ptr also is empty.
+         * The check and the new reference are one atomic step, so the object cannot be deleted in between.
          */
-        SharedPtr<T> lock() const noexcept;
+        SharedPtr<T, Counter> lock() const noexcept;
 
         // modifiers
 
@@ -66,225 +66,197 @@ namespace task {
     }
 
 
-    template<class T>
-    SharedPtr<T>::SharedPtr() noexcept = default;
+    template<class T, class Counter>
+    SharedPtr<T, Counter>::SharedPtr() noexcept = default;
 
-    template<class T>
-    SharedPtr<T>::SharedPtr(SharedPtr::pointer ptr) : current_ptr(ptr) {
-        control_block = new ControlBlock();
-        control_block->shared_ptr_counter += 1;
+    template<class T, class Counter>
+    SharedPtr<T, Counter>::SharedPtr(SharedPtr::pointer ptr) : current_ptr(ptr) {
+        control_block = new ControlBlock<Counter>();
     }
 
-    template<class T>
-    SharedPtr<T>::SharedPtr(const SharedPtr &other) noexcept {
+    template<class T, class Counter>
+    SharedPtr<T, Counter>::SharedPtr(const SharedPtr &other) noexcept {
         if (other.control_block != nullptr) {
             current_ptr = other.current_ptr;
             control_block = other.control_block;
-            control_block->shared_ptr_counter += 1; // increase as new copy
+            control_block->shared_ptr_counter.increment(); // increase as new copy
         }
     }
 
-    template<class T>
-    SharedPtr<T>::SharedPtr(SharedPtr &&r) noexcept {
+    template<class T, class Counter>
+    SharedPtr<T, Counter>::SharedPtr(SharedPtr &&r) noexcept {
         this->swap(r);
     }
 
-    template<class T>
-    SharedPtr<T>::SharedPtr(const WeakPtr<T> &w) noexcept {
-        if (w.current_ptr != nullptr) {
+    template<class T, class Counter>
+    SharedPtr<T, Counter>::SharedPtr(const WeakPtr<T, Counter> &w) noexcept {
+        if (w.current_ptr != nullptr && w.control_block->shared_ptr_counter.increment_if_not_zero()) {
             current_ptr = w.current_ptr;
             control_block = w.control_block;
-            control_block->shared_ptr_counter += 1;
         }
     }
 
-    template<class T>
-    typename SharedPtr<T>::pointer SharedPtr<T>::get() const noexcept {
-        return current_ptr;
-    }
-
-    template<class T>
-    void SharedPtr<T>::reset(SharedPtr::pointer ptr) {
-        // manage old state of *this
-        if (current_ptr != nullptr) {
-            --control_block->shared_ptr_counter;
-            if (control_block->shared_ptr_counter == 0) {
-                delete current_ptr;
-            }
-            if (control_block->shared_ptr_counter + control_block->weak_ptr_counter == 0) {
+    template<class T, class Counter>
+    void SharedPtr<T, Counter>::release() noexcept {
+        if (control_block == nullptr) {
+            return;
+        }
+        if (control_block->shared_ptr_counter.decrement() == 0) {
+            delete current_ptr;
+            if (control_block->weak_ptr_counter.decrement() == 0) { // the reference of all SharedPtr-s
                 delete control_block;
             }
         }
-        // SharedPtr<T>(ptr).swap(*this);
-        current_ptr = ptr;
-        control_block = new ControlBlock();
-        control_block->shared_ptr_counter += 1;
     }
 
-    template<class T>
-    void SharedPtr<T>::reset() noexcept {
-        // manage old state of *this
-        if (current_ptr != nullptr) {
-            --control_block->shared_ptr_counter;
-            if (control_block->shared_ptr_counter == 0) {
-                delete current_ptr;
-            }
-            if (control_block->shared_ptr_counter + control_block->weak_ptr_counter == 0) {
-                delete control_block;
-            }
-        }
-        // SharedPtr<T>().swap(*this);
-        current_ptr = nullptr;
-        control_block = nullptr;
+    template<class T, class Counter>
+    typename SharedPtr<T, Counter>::pointer SharedPtr<T, Counter>::get() const noexcept {
+        return current_ptr;
     }
 
-    template<class T>
-    void SharedPtr<T>::swap(SharedPtr &r) noexcept {
+    template<class T, class Counter>
+    void SharedPtr<T, Counter>::reset(SharedPtr::pointer ptr) {
+        SharedPtr<T, Counter>(ptr).swap(*this);
+    }
+
+    template<class T, class Counter>
+    void SharedPtr<T, Counter>::reset() noexcept {
+        SharedPtr<T, Counter>().swap(*this);
+    }
+
+    template<class T, class Counter>
+    void SharedPtr<T, Counter>::swap(SharedPtr &r) noexcept {
         std::swap(current_ptr, r.current_ptr);
         std::swap(control_block, r.control_block);
     }
 
-    template<class T>
-    typename SharedPtr<T>::element_type &SharedPtr<T>::operator*() const noexcept {
+    template<class T, class Counter>
+    typename SharedPtr<T, Counter>::element_type &SharedPtr<T, Counter>::operator*() const noexcept {
         return *get();
     }
 
-    template<class T>
-    typename SharedPtr<T>::pointer SharedPtr<T>::operator->() const noexcept {
+    template<class T, class Counter>
+    typename SharedPtr<T, Counter>::pointer SharedPtr<T, Counter>::operator->() const noexcept {
         return get();
     }
 
-    template<class T>
-    long SharedPtr<T>::use_count() const noexcept {
+    template<class T, class Counter>
+    long SharedPtr<T, Counter>::use_count() const noexcept {
         if (current_ptr == nullptr) {
             return 0;
         } else {
-            return control_block->shared_ptr_counter;
+            return control_block->shared_ptr_counter.get();
         }
     }
 
-    template<class T>
-    SharedPtr<T>::~SharedPtr() {
-        if (control_block != nullptr) {
-            --control_block->shared_ptr_counter;
-            if (control_block->shared_ptr_counter == 0) {
-                if (current_ptr != nullptr) {
-                    delete current_ptr;
-                }
-            }
-            if (control_block->shared_ptr_counter + control_block->weak_ptr_counter == 0) {
-                delete control_block;
-            }
-        }
+    template<class T, class Counter>
+    SharedPtr<T, Counter>::~SharedPtr() {
+        release();
     }
 
-    template<class T>
-    SharedPtr<T> &SharedPtr<T>::operator=(const SharedPtr &r) noexcept {
+    template<class T, class Counter>
+    SharedPtr<T, Counter> &SharedPtr<T, Counter>::operator=(const SharedPtr &r) noexcept {
         if (this == &r) {
             return *this;
         }
-        SharedPtr<T>(r).swap(*this);
+        SharedPtr<T, Counter>(r).swap(*this);
         return *this;
     }
 
-    template<class T>
-    SharedPtr<T> &SharedPtr<T>::operator=(SharedPtr &&r) noexcept {
+    template<class T, class Counter>
+    SharedPtr<T, Counter> &SharedPtr<T, Counter>::operator=(SharedPtr &&r) noexcept {
         if (this == &r) {
             return *this;
         }
-        SharedPtr<T>(std::move(r)).swap(*this);
+        SharedPtr<T, Counter>(std::move(r)).swap(*this);
         return *this;
     }
 
 
-    template<class T>
-    WeakPtr<T>::WeakPtr() noexcept = default;
+    template<class T, class Counter>
+    WeakPtr<T, Counter>::WeakPtr() noexcept = default;
 
-    template<class T>
-    WeakPtr<T>::WeakPtr(const SharedPtr<T> &s) noexcept:
+    template<class T, class Counter>
+    WeakPtr<T, Counter>::WeakPtr(const SharedPtr<T, Counter> &s) noexcept:
             current_ptr(s.get()) {
         if (current_ptr != nullptr) {
             control_block = s.control_block;
-            control_block->weak_ptr_counter += 1;
+            control_block->weak_ptr_counter.increment();
         }
     }
 
-    template<class T>
-    WeakPtr<T>::WeakPtr(const WeakPtr &r) noexcept:
+    template<class T, class Counter>
+    WeakPtr<T, Counter>::WeakPtr(const WeakPtr &r) noexcept:
             current_ptr(r.current_ptr) {
         if (current_ptr != nullptr) {
             control_block = r.control_block;
-            control_block->weak_ptr_counter += 1;
+            control_block->weak_ptr_counter.increment();
         }
     }
 
-    template<class T>
-    WeakPtr<T>::WeakPtr(WeakPtr &&w) noexcept {
+    template<class T, class Counter>
+    WeakPtr<T, Counter>::WeakPtr(WeakPtr &&w) noexcept {
         this->swap(w);
     }
 
-    template<class T>
-    WeakPtr<T>::~WeakPtr() {
+    template<class T, class Counter>
+    WeakPtr<T, Counter>::~WeakPtr() {
         if (control_block != nullptr) {
-            --control_block->weak_ptr_counter;
-            if (control_block->weak_ptr_counter + control_block->shared_ptr_counter == 0) {
+            if (control_block->weak_ptr_counter.decrement() == 0) {
                 delete control_block;
             }
         }
     }
 
-    template<class T>
-    WeakPtr<T> &WeakPtr<T>::operator=(const WeakPtr &r) noexcept {
+    template<class T, class Counter>
+    WeakPtr<T, Counter> &WeakPtr<T, Counter>::operator=(const WeakPtr &r) noexcept {
         if (this == &r) {
             return *this;
         }
-        WeakPtr<T>(r).swap(*this);
+        WeakPtr<T, Counter>(r).swap(*this);
         return *this;
     }
 
-    template<class T>
-    WeakPtr<T> &WeakPtr<T>::operator=(const SharedPtr<T> &r) noexcept {
-        WeakPtr<T>(r).swap(*this);
+    template<class T, class Counter>
+    WeakPtr<T, Counter> &WeakPtr<T, Counter>::operator=(const SharedPtr<T, Counter> &r) noexcept {
+        WeakPtr<T, Counter>(r).swap(*this);
         return *this;
     }
 
-    template<class T>
-    WeakPtr<T> &WeakPtr<T>::operator=(WeakPtr &&r) noexcept {
+    template<class T, class Counter>
+    WeakPtr<T, Counter> &WeakPtr<T, Counter>::operator=(WeakPtr &&r) noexcept {
         if (this == &r) {
             return *this;
         }
-        WeakPtr<T>(std::move(r)).swap(*this);
+        WeakPtr<T, Counter>(std::move(r)).swap(*this);
         return *this;
     }
 
-    template<class T>
-    long WeakPtr<T>::use_count() const noexcept {
+    template<class T, class Counter>
+    long WeakPtr<T, Counter>::use_count() const noexcept {
         if (control_block == nullptr) {
             return 0L;
         }
-        return control_block->shared_ptr_counter;
+        return control_block->shared_ptr_counter.get();
     }
 
-    template<class T>
-    bool WeakPtr<T>::expired() const noexcept {
+    template<class T, class Counter>
+    bool WeakPtr<T, Counter>::expired() const noexcept {
         return use_count() == 0;
     }
 
-    template<class T>
-    SharedPtr<T> WeakPtr<T>::lock() const noexcept {
-        return expired() ? SharedPtr<T>() : SharedPtr<T>(*this);
+    template<class T, class Counter>
+    SharedPtr<T, Counter> WeakPtr<T, Counter>::lock() const noexcept {
+        return SharedPtr<T, Counter>(*this);
     }
 
-    template<class T>
-    void WeakPtr<T>::reset() noexcept {
-        current_ptr = nullptr;
-        if (control_block != nullptr) {
-            --control_block->weak_ptr_counter;
-        }
+    template<class T, class Counter>
+    void WeakPtr<T, Counter>::reset() noexcept {
+        WeakPtr<T, Counter>().swap(*this);
     }
 
-    template<class T>
-    void WeakPtr<T>::swap(WeakPtr &r) noexcept {
+    template<class T, class Counter>
+    void WeakPtr<T, Counter>::swap(WeakPtr &r) noexcept {
         std::swap(current_ptr, r.current_ptr);
         std::swap(control_block, r.control_block);
     }
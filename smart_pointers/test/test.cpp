@@ -3,6 +3,8 @@
 #include <random>
 #include <algorithm>
 #include <vector>
+#include <atomic>
+#include <thread>
 #include "src/smart_pointers.h"
 
 using task::UniquePtr;
@@ -40,6 +42,15 @@ struct Node {
     ~Node() {}
 };
 
+struct Tracked {
+    static std::atomic<int> alive;
+    int value;
+    Tracked(int value): value(value) { ++alive; }
+    ~Tracked() { value = -1; --alive; }
+};
+
+std::atomic<int> Tracked::alive{0};
+
 SharedPtr<Node> getCyclePtr(int cycleSize) {
     SharedPtr<Node> head(new Node(0));
     SharedPtr<Node> prev(head);
@@ -193,4 +204,59 @@ int main() {
         }
     }
 
+    {
+        auto sp = SharedPtr<Tracked>(new Tracked(7));
+        {
+            WeakPtr<Tracked> weak = sp;
+            weak.reset();
+            ASSERT_TRUE(weak.use_count() == 0);
+            ASSERT_TRUE(weak.expired());
+            ASSERT_TRUE(weak.lock().get() == nullptr);
+            weak.reset();
+        }
+        ASSERT_TRUE(sp.use_count() == 1);
+
+        WeakPtr<Tracked> weak = sp;
+        sp.reset();
+        ASSERT_TRUE(Tracked::alive == 0);
+        ASSERT_TRUE(weak.expired());
+        weak.reset();
+        ASSERT_TRUE(weak.lock().get() == nullptr);
+    }
+
+    {
+        const int threads = 4;
+        for (int round = 0; round < 1'000; ++round) {
+            auto sp = SharedPtr<Tracked>(new Tracked(round));
+            WeakPtr<Tracked> weak = sp;
+            std::atomic<int> started{0};
+            std::atomic<bool> failed{false};
+            std::vector<std::thread> lockers;
+            for (int i = 0; i < threads; ++i) {
+                lockers.emplace_back([&]() {
+                    ++started;
+                    for (int k = 0; k < 10'000; ++k) {
+                        SharedPtr<Tracked> locked = weak.lock();
+                        if (locked.get() == nullptr) {
+                            break;
+                        }
+                        if (locked->value != round || locked.use_count() < 1) {
+                            failed = true;
+                        }
+                    }
+                });
+            }
+            while (started < threads) {
+                std::this_thread::yield();
+            }
+            sp.reset();
+            for (auto& locker : lockers) {
+                locker.join();
+            }
+            ASSERT_TRUE_MSG(!failed, "lock() returned a pointer to a released object");
+            ASSERT_TRUE(weak.expired());
+            ASSERT_TRUE(Tracked::alive == 0);
+        }
+    }
+
 }